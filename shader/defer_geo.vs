@@ -1,7 +1,5 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+#include "include/vertex_input.glsl"
 
 uniform mat4 transform;
 uniform mat4 modelTransform;
@@ -11,8 +9,9 @@ out vec2 texCoord;
 out vec3 position;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
-    normal = (transpose(inverse(modelTransform)) * vec4(aNormal, 0.0)).xyz;
+    vec3 pos = VertexPosition();
+    gl_Position = transform * vec4(pos, 1.0);
+    normal = (transpose(inverse(modelTransform)) * vec4(VertexNormal(), 0.0)).xyz;
     texCoord = aTexCoord;
-    position = (modelTransform * vec4(aPos, 1.0)).xyz;
+    position = (modelTransform * vec4(pos, 1.0)).xyz;
 }
\ No newline at end of file
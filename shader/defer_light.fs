@@ -5,15 +5,14 @@ in vec2 texCoord;
 uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;	
+// ssao는 USE_SSAO define으로 켠다
+#ifdef USE_SSAO
 uniform sampler2D ssao;
-uniform int useSsao;
+#endif
 
-struct Light {
-    vec3 position;
-    vec3 color;
-};
+#include "include/point_light.glsl"
 const int NR_LIGHTS = 32;
-uniform Light lights[NR_LIGHTS];
+uniform PointLight lights[NR_LIGHTS];
 uniform vec3 viewPos;
 void main() {
     // retrieve data from G-buffer
@@ -22,9 +21,11 @@ void main() {
     vec3 albedo = texture(gAlbedoSpec, texCoord).rgb;
     float specular = texture(gAlbedoSpec, texCoord).a;
     // then calculate lighting as usual  	
-    vec3 ambient = useSsao == 1 ?
-        texture(ssao, texCoord).r * 0.4 * albedo :
-        albedo * 0.4; // hard-coded ambient component
+#ifdef USE_SSAO
+    vec3 ambient = texture(ssao, texCoord).r * 0.4 * albedo;
+#else
+    vec3 ambient = albedo * 0.4; // hard-coded ambient component
+#endif
     vec3 lighting = ambient; 
     
     vec3 viewDir = normalize(viewPos - fragPos);
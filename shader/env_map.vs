@@ -1,6 +1,5 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+#include "include/vertex_input.glsl"
 
 out vec3 normal;
 out vec3 position;
@@ -10,7 +9,7 @@ uniform mat4 view;
 uniform mat4 projection;
 
 void main() {
-    normal = mat3(transpose(inverse(model))) * aNormal;
-    position = vec3(model * vec4(aPos, 1.0));
+    normal = mat3(transpose(inverse(model))) * VertexNormal();
+    position = vec3(model * vec4(VertexPosition(), 1.0));
     gl_Position = projection * view * vec4(position, 1.0);
 }
\ No newline at end of file
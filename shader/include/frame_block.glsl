@@ -0,0 +1,7 @@
+// binding point 0, Context에서 프레임마다 갱신 (uniform_block.h의 PerFrameBlock)
+layout (std140) uniform PerFrame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 viewPos;
+};
\ No newline at end of file
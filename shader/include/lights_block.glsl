@@ -0,0 +1,17 @@
+// binding point 1, Context에서 프레임마다 갱신 (uniform_block.h의 LightsBlock)
+// vertex / fragment shader 모두 같은 정의를 include 해야 link 된다
+struct Light {
+    vec3 position;
+    vec3 direction;
+    vec3 attenuation;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+layout (std140) uniform Lights {
+    mat4 lightTransform;
+    Light light;
+    float shadowNearPlane;
+    float shadowFarPlane;
+    int omniShadow;
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+// Cook-Torrance BRDF 구성 함수
+const float PI = 3.14159265359;
+
+float DistributionGGX(vec3 normal, vec3 halfDir, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float dotNH = max(dot(normal, halfDir), 0.0);
+    float dotNH2 = dotNH * dotNH;
+
+    float num = a2;
+    float denom = (dotNH2 * (a2 - 1.0) + 1.0);
+    return a2 / (PI * denom * denom);
+}
+
+float GeometrySchlickGGX(float dotNV, float roughness) {
+    float r = (roughness + 1.0);
+    float k = (r*r) / 8.0;
+
+    float num = dotNV;
+    float denom = dotNV * (1.0 - k) + k;
+    return num / denom;
+}
+
+float GeometrySmith(vec3 normal, vec3 viewDir, vec3 lightDir, float roughness) {
+    float dotNV = max(dot(normal, viewDir), 0.0);
+    float dotNL = max(dot(normal, lightDir), 0.0);
+    float ggx2 = GeometrySchlickGGX(dotNV, roughness);
+    float ggx1 = GeometrySchlickGGX(dotNL, roughness);
+    return ggx1 * ggx2;
+}
+
+vec3 FresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
+}
+
+vec3 FresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - cosTheta, 5.0);
+}
\ No newline at end of file
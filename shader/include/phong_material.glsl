@@ -0,0 +1,6 @@
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+uniform Material material;
\ No newline at end of file
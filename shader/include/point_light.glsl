@@ -0,0 +1,4 @@
+struct PointLight {
+    vec3 position;
+    vec3 color;
+};
\ No newline at end of file
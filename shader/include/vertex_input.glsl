@@ -0,0 +1,33 @@
+// Mesh의 vertex attribute (mesh.h의 VertexFormat)
+// compact format은 normal / tangent를 octahedral 2 성분으로,
+// quantized position은 mesh AABB 기준 [0, 1]로 저장하므로 여기서 풀어서 사용한다
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aTangent;
+
+// Mesh::Draw에서 설정, bit 0: octahedral normal / tangent, bit 1: quantized position
+uniform int vertexFormat;
+uniform vec3 vertexPositionScale;
+uniform vec3 vertexPositionOffset;
+
+vec3 OctDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+vec3 VertexPosition() {
+    if ((vertexFormat & 2) != 0)
+        return aPos * vertexPositionScale + vertexPositionOffset;
+    return aPos;
+}
+
+vec3 VertexNormal() {
+    return (vertexFormat & 1) != 0 ? OctDecode(aNormal.xy) : aNormal;
+}
+
+vec3 VertexTangent() {
+    return (vertexFormat & 1) != 0 ? OctDecode(aTangent.xy) : aTangent;
+}
\ No newline at end of file
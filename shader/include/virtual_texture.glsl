@@ -0,0 +1,36 @@
+// VirtualTexture::SetToProgram에서 설정된다
+uniform sampler2D vtPageTable;      // texel = (atlas slot x, y, 올라와 있는 level, 255)
+uniform sampler2D vtAtlas;
+uniform vec2 vtTileCount;           // level 0의 tile 수
+uniform vec2 vtTileSize;            // x: border를 뺀 tile 크기, y: border
+uniform float vtLevelCount;
+uniform float vtAtlasSize;
+
+// level 0 texel 기준 미분으로 필요한 mip level을 구한다
+float VirtualTextureLevel(vec2 uv, float bias) {
+    vec2 texel = uv * vtTileCount * vtTileSize.x;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float level = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + bias;
+    return clamp(floor(level), 0.0, vtLevelCount - 1.0);
+}
+
+ivec2 VirtualTextureTileCount(int level) {
+    return max(ivec2(vtTileCount) >> level, ivec2(1));
+}
+
+vec4 VirtualTextureSample(vec2 uv) {
+    // 미분은 경도 경계에서 끊기지 않도록 wrap 전에 구한다
+    int level = int(VirtualTextureLevel(uv, 0.0));
+    uv = vec2(fract(uv.x), clamp(uv.y, 0.0, 1.0));
+    ivec2 tileCount = VirtualTextureTileCount(level);
+    ivec2 tile = min(ivec2(uv * vec2(tileCount)), tileCount - 1);
+    vec3 entry = texelFetch(vtPageTable, tile, level).xyz * 255.0;
+
+    // 요청한 level이 없으면 entry는 상위 level tile을 가리킨다
+    vec2 residentTileCount = vec2(VirtualTextureTileCount(int(entry.z + 0.5)));
+    vec2 inTile = uv * residentTileCount - min(floor(uv * residentTileCount), residentTileCount - 1.0);
+    vec2 atlasTexel = floor(entry.xy + 0.5) * (vtTileSize.x + 2.0 * vtTileSize.y) +
+        vtTileSize.y + inTile * vtTileSize.x;
+    return textureLod(vtAtlas, atlasTexel / vtAtlasSize, 0.0);
+}
\ No newline at end of file
@@ -18,12 +18,7 @@ struct Light {
 uniform Light light;
 uniform int blinn;
  
-struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    float shininess;
-};
-uniform Material material;
+#include "include/phong_material.glsl"
 
 void main() {
     vec3 texColor = texture2D(material.diffuse, texCoord).xyz;
@@ -9,52 +9,101 @@ in VS_OUT {
     vec4 fragPosLight;
 } fs_in;
 
-uniform vec3 viewPos;
-struct Light {
-    vec3 position;
-    vec3 direction;
-    vec3 attenuation;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-uniform Light light;
+#include "include/frame_block.glsl"
 
-struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    float shininess;
-};
-uniform Material material;
-uniform sampler2D shadowMap;
+#include "include/lights_block.glsl"
+#include "include/phong_material.glsl"
+uniform sampler2DShadow shadowMap;
+uniform samplerCubeShadow shadowCubeMap;
+
+// 가까이서 보는 천체는 diffuse 대신 virtual texture를 사용한다
+#ifdef VIRTUAL_TEXTURE
+#include "include/virtual_texture.glsl"
+#endif
+
+// PCF tap 수는 program 생성 시 define으로 결정된다 (1, 4, 16)
+#ifndef SHADOW_PCF_TAPS
+#define SHADOW_PCF_TAPS 4
+#endif
+
+// 앞의 4개만으로도 고르게 퍼지도록 배치된 poisson disk
+const vec2 poissonDisk[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2( 0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2( 0.34495938,  0.29387760),
+    vec2(-0.91588581,  0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543,  0.27676845), vec2( 0.97484398,  0.75648379),
+    vec2( 0.44323325, -0.97511554), vec2( 0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2( 0.79197514,  0.19090188),
+    vec2(-0.24188840,  0.99706507), vec2(-0.81409955,  0.91437590),
+    vec2( 0.19984126,  0.78641367), vec2( 0.14383161, -0.14100790)
+);
+const float pcfRadius = 1.5;
 
 float ShadowCalculation(vec4 fragPosLight, vec3 normal, vec3 lightDir) {
     // perform perspective divide
     vec3 projCoords = fragPosLight.xyz / fragPosLight.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    // get closest depth value from light’s perspective (using
-    // [0,1] range fragPosLight as coords)
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
-    // get depth of current fragment from light’s perspective
-    float currentDepth = projCoords.z;
+    if (projCoords.z > 1.0)
+        return 0.0;
     // check whether current frag pos is in shadow / 정확하지 않은 depth값 때문에 줄무늬가 형성대는걸 방지하기위해 bias값 이용
     float bias = max(0.02 * (1.0 - dot(normal, lightDir)), 0.001); 	
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-    for(int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap,
-                projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-        }
+    float currentDepth = projCoords.z - bias;
+    // sampler2DShadow는 비교 결과(1.0 = 빛을 받음)를 2x2 texel에 대해 보간해서 돌려준다
+#if SHADOW_PCF_TAPS == 1
+    float lit = texture(shadowMap, vec3(projCoords.xy, currentDepth));
+#else
+    vec2 texelSize = pcfRadius / textureSize(shadowMap, 0);
+    float lit = 0.0;
+    for (int i = 0; i < SHADOW_PCF_TAPS; i++) {
+        lit += texture(shadowMap,
+            vec3(projCoords.xy + poissonDisk[i] * texelSize, currentDepth));
+    }
+    lit /= float(SHADOW_PCF_TAPS);
+#endif
+    return 1.0 - lit;
+}
+
+// cube map face의 perspective projection으로 기록된 depth 값을 복원한다
+float VectorToDepth(vec3 v) {
+    vec3 absV = abs(v);
+    float z = max(absV.x, max(absV.y, absV.z));
+    float n = shadowNearPlane;
+    float f = shadowFarPlane;
+    float ndc = (f + n) / (f - n) - (2.0 * f * n) / ((f - n) * z);
+    return ndc * 0.5 + 0.5;
+}
+
+float OmniShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightDir) {
+    vec3 lightToFrag = fragPos - light.position;
+    float bias = max(0.0005 * (1.0 - dot(normal, lightDir)), 0.00005);
+    float currentDepth = VectorToDepth(lightToFrag) - bias;
+#if SHADOW_PCF_TAPS == 1
+    float lit = texture(shadowCubeMap, vec4(lightToFrag, currentDepth));
+#else
+    // 빛 방향에 수직인 평면 위에서 poisson disk만큼 방향을 흔든다
+    vec3 up = abs(lightToFrag.y) < 0.99 * length(lightToFrag) ?
+        vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 tangent = normalize(cross(up, lightToFrag));
+    vec3 bitangent = normalize(cross(lightToFrag, tangent));
+    float texelSize = 2.0 * pcfRadius * length(lightToFrag) /
+        float(textureSize(shadowCubeMap, 0).x);
+    float lit = 0.0;
+    for (int i = 0; i < SHADOW_PCF_TAPS; i++) {
+        vec3 offset = (poissonDisk[i].x * tangent + poissonDisk[i].y * bitangent) * texelSize;
+        lit += texture(shadowCubeMap, vec4(lightToFrag + offset, currentDepth));
     }
-    shadow /= 9.0;
-    return shadow;
+    lit /= float(SHADOW_PCF_TAPS);
+#endif
+    return 1.0 - lit;
 }
 
 void main() {
+#ifdef VIRTUAL_TEXTURE
+    vec3 texColor = VirtualTextureSample(fs_in.texCoord).xyz;
+#else
     vec3 texColor = texture2D(material.diffuse, fs_in.texCoord).xyz;
+#endif
     vec3 ambient = texColor * light.ambient;
 
     vec3 result = ambient;
@@ -79,7 +128,9 @@ void main() {
     spec = pow(max(dot(halfDir, pixelNorm), 0.0), material.shininess);
         
     vec3 specular = spec * specColor * light.specular;
-    float shadow = ShadowCalculation(fs_in.fragPosLight, pixelNorm, lightDir);
+    float shadow = omniShadow != 0 ?
+        OmniShadowCalculation(fs_in.fragPos, pixelNorm, lightDir) :
+        ShadowCalculation(fs_in.fragPosLight, pixelNorm, lightDir);
 
     result += (diffuse + specular) * (1.0 - shadow);
     
@@ -1,8 +1,7 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+#include "include/vertex_input.glsl"
+layout (location = 4) in mat4 aModelTransform;
 
 out VS_OUT {
     vec3 fragPos;
@@ -11,14 +10,15 @@ out VS_OUT {
     vec4 fragPosLight;
 } vs_out;
 
-uniform mat4 transform;
-uniform mat4 modelTransform;
-uniform mat4 lightTransform;
+#include "include/frame_block.glsl"
+
+#include "include/lights_block.glsl"
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
-    vs_out.fragPos = vec3(modelTransform * vec4(aPos, 1.0));
-    vs_out.normal = transpose(inverse(mat3(modelTransform))) * aNormal;
+    vec4 worldPos = aModelTransform * vec4(VertexPosition(), 1.0);
+    gl_Position = viewProjection * worldPos;
+    vs_out.fragPos = vec3(worldPos);
+    vs_out.normal = transpose(inverse(mat3(aModelTransform))) * VertexNormal();
     vs_out.texCoord = aTexCoord;
     vs_out.fragPosLight = lightTransform * vec4(vs_out.fragPos, 1.0);
 }
\ No newline at end of file
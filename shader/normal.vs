@@ -1,9 +1,6 @@
 #version 330 core
 	
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
-layout (location = 3) in vec3 aTangent;
+#include "include/vertex_input.glsl"
 
 uniform mat4 transform;
 uniform mat4 modelTransform;
@@ -14,11 +11,12 @@ out vec3 normal;
 out vec3 tangent;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
+    vec3 pos = VertexPosition();
+    gl_Position = transform * vec4(pos, 1.0);
     texCoord = aTexCoord;
-    position = (modelTransform * vec4(aPos, 1.0)).xyz;
+    position = (modelTransform * vec4(pos, 1.0)).xyz;
 
     mat4 invTransModelTransform = transpose(inverse(modelTransform));
-    normal = (invTransModelTransform * vec4(aNormal, 0.0)).xyz;
-    tangent = (invTransModelTransform * vec4(aTangent, 0.0)).xyz;
+    normal = (invTransModelTransform * vec4(VertexNormal(), 0.0)).xyz;
+    tangent = (invTransModelTransform * vec4(VertexTangent(), 0.0)).xyz;
 }
\ No newline at end of file
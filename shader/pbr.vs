@@ -1,7 +1,5 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+#include "include/vertex_input.glsl"
 
 uniform mat4 transform;
 uniform mat4 modelTransform;
@@ -11,8 +9,9 @@ out vec3 normal;
 out vec2 texCoord;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
-    fragPos = (modelTransform * vec4(aPos, 1.0)).xyz;
-    normal = (transpose(inverse(modelTransform)) * vec4(aNormal, 0.0)).xyz;
+    vec3 pos = VertexPosition();
+    gl_Position = transform * vec4(pos, 1.0);
+    fragPos = (modelTransform * vec4(pos, 1.0)).xyz;
+    normal = (transpose(inverse(modelTransform)) * vec4(VertexNormal(), 0.0)).xyz;
     texCoord = aTexCoord;
 }
\ No newline at end of file
@@ -7,12 +7,9 @@ out vec4 fragColor;
 
 uniform vec3 viewPos;
 
-struct Light {
-    vec3 position;
-    vec3 color;
-};
+#include "include/point_light.glsl"
 const int LIGHT_COUNT = 4;
-uniform Light lights[LIGHT_COUNT];
+uniform PointLight lights[LIGHT_COUNT];
 
 struct Material {
     sampler2D albedo;
@@ -23,39 +20,7 @@ struct Material {
 };
 uniform Material material;
 
-const float PI = 3.14159265359;
-
-float DistributionGGX(vec3 normal, vec3 halfDir, float roughness) {
-    float a = roughness * roughness;
-    float a2 = a * a;
-    float dotNH = max(dot(normal, halfDir), 0.0);
-    float dotNH2 = dotNH * dotNH;
-
-    float num = a2;
-    float denom = (dotNH2 * (a2 - 1.0) + 1.0);
-    return a2 / (PI * denom * denom);
-}
-
-float GeometrySchlickGGX(float dotNV, float roughness) {
-    float r = (roughness + 1.0);
-    float k = (r*r) / 8.0;
-
-    float num = dotNV;
-    float denom = dotNV * (1.0 - k) + k;
-    return num / denom;
-}
-
-float GeometrySmith(vec3 normal, vec3 viewDir, vec3 lightDir, float roughness) {
-    float dotNV = max(dot(normal, viewDir), 0.0);
-    float dotNL = max(dot(normal, lightDir), 0.0);
-    float ggx2 = GeometrySchlickGGX(dotNV, roughness);
-    float ggx1 = GeometrySchlickGGX(dotNL, roughness);
-    return ggx1 * ggx2;
-}
-
-vec3 FresnelSchlick(float cosTheta, vec3 F0) {
-    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
-}
+#include "include/pbr_brdf.glsl"
 
 void main() {
     vec3 albedo = pow(texture(material.albedo, texCoord).rgb, vec3(2.2));
@@ -0,0 +1,5 @@
+#version 330 core
+
+// depth만 기록한다
+void main() {
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+
+#include "include/vertex_input.glsl"
+layout (location = 4) in mat4 aModelTransform;
+
+uniform mat4 transform;
+
+void main() {
+    gl_Position = transform * aModelTransform * vec4(VertexPosition(), 1.0);
+}
\ No newline at end of file
@@ -1,9 +1,10 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+#include "include/vertex_input.glsl"
 
-uniform mat4 transform;
+#include "include/frame_block.glsl"
+uniform mat4 modelTransform;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
+    gl_Position = viewProjection * modelTransform * vec4(VertexPosition(), 1.0);
 }
 
@@ -3,9 +3,10 @@
 layout (location = 0) in vec3 aPos;
 out vec3 texCoord;
 
-uniform mat4 transform;
+#include "include/frame_block.glsl"
+uniform mat4 modelTransform;
 
 void main() {
     texCoord = aPos;
-    gl_Position = transform * vec4(aPos, 1.0);
+    gl_Position = viewProjection * modelTransform * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 330 core
+
+in VS_OUT {
+    vec3 fragPos;
+    vec3 normal;
+    vec2 texCoord;
+    vec4 fragPosLight;
+} fs_in;
+
+out vec4 fragColor;
+
+#include "include/virtual_texture.glsl"
+uniform int vtId;
+uniform float vtFeedbackBias;       // feedback buffer가 작은 만큼 level을 낮춘다
+
+void main() {
+    int level = int(VirtualTextureLevel(fs_in.texCoord, vtFeedbackBias));
+    vec2 uv = vec2(fract(fs_in.texCoord.x), clamp(fs_in.texCoord.y, 0.0, 1.0));
+    ivec2 tileCount = VirtualTextureTileCount(level);
+    ivec2 tile = min(ivec2(uv * vec2(tileCount)), tileCount - 1);
+    // VirtualTextureFeedback의 pixel 형식
+    fragColor = vec4(
+        float(tile.x & 255),
+        float(tile.y & 255),
+        float((tile.x >> 8) | ((tile.y >> 8) << 4)),
+        float(level | ((vtId + 1) << 4))) / 255.0;
+}
\ No newline at end of file
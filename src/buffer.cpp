@@ -19,12 +19,32 @@ void Buffer::Bind() const {
     glBindBuffer(m_bufferType, m_buffer);
 }
 
+// GL_UNIFORM_BUFFER 등 indexed target의 binding point에 연결
+void Buffer::BindBase(uint32_t bindingPoint) const {
+    glBindBufferBase(m_bufferType, bindingPoint, m_buffer);
+}
+
+void Buffer::Update(const void* data, size_t count) {
+    Bind();
+    if (count > m_capacity) {
+        m_capacity = count;
+        glBufferData(m_bufferType, m_stride * m_capacity, data, m_usage);
+    }
+    else {
+        // 이전 프레임이 아직 사용 중인 storage를 기다리지 않도록 orphaning
+        glBufferData(m_bufferType, m_stride * m_capacity, nullptr, m_usage);
+        glBufferSubData(m_bufferType, 0, m_stride * count, data);
+    }
+    m_count = count;
+}
+
 bool Buffer::Init(uint32_t bufferType, uint32_t usage,
     const void* data, size_t stride, size_t count) { 
     m_bufferType = bufferType;
     m_usage = usage;
     m_stride = stride;
     m_count = count;
+    m_capacity = count;
     glGenBuffers(1, &m_buffer);
     Bind();
     glBufferData(m_bufferType, m_stride * m_count, data, usage);
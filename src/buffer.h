@@ -14,6 +14,8 @@ public:
     size_t GetStride() const { return m_stride; }
     size_t GetCount() const { return m_count; }
     void Bind() const;
+    void BindBase(uint32_t bindingPoint) const;
+    void Update(const void* data, size_t count);
 
 private:
     Buffer() {}
@@ -24,6 +26,7 @@ private:
     uint32_t m_usage { 0 };
     size_t m_stride { 0 };
     size_t m_count { 0 };
+    size_t m_capacity { 0 };
 };
 
 #endif // __BUFFER_H__
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "celestial_body.h"
+
+CelestialBodyTableUPtr CelestialBodyTable::Create(const glm::dvec3& origin) {
+    auto table = CelestialBodyTableUPtr(new CelestialBodyTable());
+    table->m_origin = origin;
+    table->m_orbits = KeplerOrbitTable::Create();
+    return std::move(table);
+}
+
+int CelestialBodyTable::AddBody(const CelestialBody& body) {
+    int index = (int)GetCount();
+    // Update는 부모가 자식보다 먼저 계산된다고 가정한다
+    if (body.parent >= index) {
+        SPDLOG_ERROR("parent of body \"{}\" must be added first: {}", body.name, body.parent);
+        return -1;
+    }
+
+    m_name.push_back(body.name);
+    m_scale.push_back(body.scale);
+    m_orbitRadius.push_back(body.orbitRadius);
+    m_mass.push_back(body.mass);
+    m_spinRate.push_back(body.spinRate);
+    m_spinAxis.push_back(body.spinAxis);
+    m_parent.push_back(body.parent);
+    m_castsShadow.push_back(body.castsShadow ? 1 : 0);
+    m_mesh.push_back(body.mesh);
+    m_material.push_back(body.material);
+
+    KeplerElements elements;
+    elements.semiMajorAxis = body.orbitRadius;
+    elements.eccentricity = body.eccentricity;
+    elements.inclination = body.inclination;
+    elements.ascendingNode = body.ascendingNode;
+    elements.argumentOfPeriapsis = body.argumentOfPeriapsis;
+    elements.meanAnomaly = body.orbitPhase;
+    elements.period = body.orbitPeriod;
+    m_orbits->AddOrbit(elements);
+
+    m_orbitX.push_back(0.0f);
+    m_orbitY.push_back(0.0f);
+    m_orbitZ.push_back(0.0f);
+    m_position.push_back(m_origin);
+    m_relativePosition.push_back(glm::vec3(0.0f));
+    m_relativeTransform.push_back(glm::mat4(1.0f));
+    return index;
+}
+
+int CelestialBodyTable::FindBody(const std::string& name) const {
+    for (size_t i = 0; i < m_name.size(); i++) {
+        if (m_name[i] == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+// count 이후에 추가된 천체를 모두 제거한다
+void CelestialBodyTable::Truncate(size_t count) {
+    if (count >= GetCount())
+        return;
+    m_name.resize(count);
+    m_scale.resize(count);
+    m_orbitRadius.resize(count);
+    m_mass.resize(count);
+    m_spinRate.resize(count);
+    m_spinAxis.resize(count);
+    m_parent.resize(count);
+    m_castsShadow.resize(count);
+    m_mesh.resize(count);
+    m_material.resize(count);
+    m_orbits->Truncate(count);
+    m_orbitX.resize(count);
+    m_orbitY.resize(count);
+    m_orbitZ.resize(count);
+    m_position.resize(count);
+    m_relativePosition.resize(count);
+    m_relativeTransform.resize(count);
+}
+
+void CelestialBodyTable::Update(double time, bool revolution, bool rotating) {
+    const size_t count = GetCount();
+    const double orbitTime = revolution ? time : 0.0;
+
+    // 부모 기준 타원 궤도 위치, 평균 근점 이각은 double에서 한 바퀴 안으로 접힌다
+    m_orbits->Propagate(orbitTime, m_orbitX.data(), m_orbitY.data(), m_orbitZ.data());
+
+    // 부모가 항상 앞에 있으므로 한 번의 순회로 world 위치가 계산된다
+    // 부모 기준 offset은 float여도 부모 위치에 더하는 것은 double이라 거리가 멀어도 오차가 쌓이지 않는다
+    const float* orbitX = m_orbitX.data();
+    const float* orbitY = m_orbitY.data();
+    const float* orbitZ = m_orbitZ.data();
+    const int* parent = m_parent.data();
+    glm::dvec3* position = m_position.data();
+    for (size_t i = 0; i < count; i++) {
+        glm::dvec3 center = parent[i] < 0 ? m_origin : position[parent[i]];
+        position[i] = center + glm::dvec3(orbitX[i], orbitY[i], orbitZ[i]);
+    }
+    m_spinTime = rotating ? time : 0.0;
+}
+
+void CelestialBodyTable::Update(double time, const glm::dvec3* positions, bool rotating) {
+    std::copy(positions, positions + GetCount(), m_position.begin());
+    m_spinTime = rotating ? time : 0.0;
+}
+
+// 자전 및 origin 기준 transform
+void CelestialBodyTable::UpdateTransforms(const glm::dvec3& origin) {
+    const size_t count = GetCount();
+    const glm::dvec3* position = m_position.data();
+    const float* scale = m_scale.data();
+    const float* spinRate = m_spinRate.data();
+    const glm::vec3* spinAxis = m_spinAxis.data();
+    glm::vec3* relativePosition = m_relativePosition.data();
+    glm::mat4* relativeTransform = m_relativeTransform.data();
+    for (size_t i = 0; i < count; i++) {
+        float spinAngle = (float)fmod(m_spinTime * spinRate[i], 360.0);
+        relativePosition[i] = glm::vec3(position[i] - origin);
+        relativeTransform[i] =
+            glm::translate(glm::mat4(1.0f), relativePosition[i]) *
+            glm::rotate(glm::mat4(1.0f), glm::radians(spinAngle), spinAxis[i]) *
+            glm::scale(glm::mat4(1.0f), glm::vec3(scale[i]));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef __CELESTIAL_BODY_H__
+#define __CELESTIAL_BODY_H__
+
+#include "common.h"
+#include "mesh.h"
+#include "kepler_orbit.h"
+
+// 천체 하나를 기술하는 값. CelestialBodyTable::AddBody로 테이블에 추가한다
+struct CelestialBody {
+    std::string name;
+    float scale { 1.0f };           // 지름 1.0인 구 mesh에 곱해지는 크기
+    float orbitRadius { 0.0f };     // 부모 천체 기준 궤도 긴반지름
+    float orbitPeriod { 0.0f };     // 공전주기(일), 0이면 공전하지 않음
+    float orbitPhase { 0.0f };      // 시작 평균 근점 이각(radian)
+    float eccentricity { 0.0f };    // 궤도 이심률, 0이면 원
+    float inclination { 0.0f };     // 궤도 경사(radian), xz 평면 기준
+    float ascendingNode { 0.0f };   // 승교점 경도(radian)
+    float argumentOfPeriapsis { 0.0f }; // 근점 인수(radian)
+    float mass { 0.0f };            // 태양 질량 단위, n-body 물리 모드에서만 쓰인다
+    float spinRate { 0.0f };        // 하루당 자전 각(degree)
+    glm::vec3 spinAxis { glm::vec3(0.0f, 1.0f, 0.0f) };
+    int parent { -1 };              // 부모 천체 index, -1이면 origin 기준
+    bool castsShadow { true };      // 광원을 품고 있는 태양은 false
+    MeshPtr mesh;
+    MaterialPtr material;
+};
+
+CLASS_PTR(CelestialBodyTable)
+class CelestialBodyTable {
+public:
+    static CelestialBodyTableUPtr Create(const glm::dvec3& origin = glm::dvec3(0.0));
+
+    int AddBody(const CelestialBody& body);
+    int FindBody(const std::string& name) const;
+    void Truncate(size_t count);
+    // time: 시뮬레이션 시간(일), 공전 위치는 KeplerOrbitTable로 계산한다
+    void Update(double time, bool revolution, bool rotating);
+    // 위치를 밖에서(n-body 시뮬레이션 등) 받는다
+    void Update(double time, const glm::dvec3* positions, bool rotating);
+    // world 위치는 double로 두고, GPU에 올릴 transform은 origin(카메라) 기준으로 빼서 float로 만든다
+    // 멀리 떨어진 천체도 카메라 근처에서는 float 정밀도를 그대로 쓸 수 있다
+    void UpdateTransforms(const glm::dvec3& origin);
+
+    size_t GetCount() const { return m_scale.size(); }
+    const std::string& GetName(size_t index) const { return m_name[index]; }
+    float GetScale(size_t index) const { return m_scale[index]; }
+    float GetOrbitRadius(size_t index) const { return m_orbitRadius[index]; }
+    float GetMass(size_t index) const { return m_mass[index]; }
+    int GetParent(size_t index) const { return m_parent[index]; }
+    bool GetCastsShadow(size_t index) const { return m_castsShadow[index] != 0; }
+    MeshPtr GetMesh(size_t index) const { return m_mesh[index]; }
+    // LOD 선택 등으로 그릴 mesh만 바꾼다
+    void SetMesh(size_t index, MeshPtr mesh) { m_mesh[index] = mesh; }
+    MaterialPtr GetMaterial(size_t index) const { return m_material[index]; }
+
+    const glm::dvec3& GetPosition(size_t index) const { return m_position[index]; }
+    // UpdateTransforms에 넘긴 origin 기준 값
+    const glm::vec3& GetRelativePosition(size_t index) const { return m_relativePosition[index]; }
+    const glm::mat4& GetRelativeTransform(size_t index) const { return m_relativeTransform[index]; }
+    const std::vector<glm::mat4>& GetRelativeTransforms() const { return m_relativeTransform; }
+
+private:
+    CelestialBodyTable() {}
+    glm::dvec3 m_origin { glm::dvec3(0.0) };
+    double m_spinTime { 0.0 };
+    KeplerOrbitTableUPtr m_orbits;
+
+    // 천체 속성 (structure-of-arrays)
+    std::vector<std::string> m_name;
+    std::vector<float> m_scale;
+    std::vector<float> m_orbitRadius;
+    std::vector<float> m_mass;
+    std::vector<float> m_spinRate;
+    std::vector<glm::vec3> m_spinAxis;
+    std::vector<int> m_parent;
+    std::vector<uint8_t> m_castsShadow;
+    std::vector<MeshPtr> m_mesh;
+    std::vector<MaterialPtr> m_material;
+
+    // 매 프레임 Update에서 계산되는 값
+    std::vector<float> m_orbitX, m_orbitY, m_orbitZ;   // 부모 기준 공전 위치
+    std::vector<glm::dvec3> m_position;
+    std::vector<glm::vec3> m_relativePosition;
+    std::vector<glm::mat4> m_relativeTransform;
+};
+
+#endif // __CELESTIAL_BODY_H__
\ No newline at end of file
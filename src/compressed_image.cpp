@@ -0,0 +1,203 @@
+#include "compressed_image.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+static uint32_t MakeFourCC(const char* code) {
+    return (uint32_t)code[0] | ((uint32_t)code[1] << 8) |
+        ((uint32_t)code[2] << 16) | ((uint32_t)code[3] << 24);
+}
+
+static uint32_t ReadUint32(const uint8_t* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// 4x4 block 하나의 크기, 지원하지 않는 format이면 0
+static size_t GetBlockSize(uint32_t format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+static size_t GetLevelSize(uint32_t format, int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+CompressedImageUPtr CompressedImage::Load(const std::string& filepath) {
+    std::ifstream fin(filepath, std::ios::binary);
+    if (!fin.is_open()) {
+        SPDLOG_ERROR("failed to open file: {}", filepath);
+        return nullptr;
+    }
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(fin)),
+        std::istreambuf_iterator<char>());
+
+    auto image = CompressedImageUPtr(new CompressedImage());
+    auto extension = filepath.substr(filepath.find_last_of('.') + 1);
+    bool result = extension == "ktx" ?
+        image->LoadKtx(filepath, file) :
+        image->LoadDds(filepath, file);
+    if (!result)
+        return nullptr;
+    return std::move(image);
+}
+
+uint32_t CompressedImage::GetSrgbFormat(uint32_t format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case GL_COMPRESSED_RGBA_BPTC_UNORM: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        default: return format;
+    }
+}
+
+bool CompressedImage::IsFormatSupported(uint32_t format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return GLAD_GL_EXT_texture_compression_s3tc;
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return GLAD_GL_EXT_texture_compression_s3tc && GLAD_GL_EXT_texture_sRGB;
+        case GL_COMPRESSED_RG_RGTC2:
+            return true;    // GL 3.0 core
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+        default:
+            return false;
+    }
+}
+
+// mip level은 큰 것부터 순서대로 붙어 있다고 가정 (DDS)
+void CompressedImage::AddLevels(const uint8_t* data, size_t dataSize, size_t levelCount) {
+    size_t offset = 0;
+    int width = m_width;
+    int height = m_height;
+    for (size_t i = 0; i < levelCount; i++) {
+        size_t size = GetLevelSize(m_format, width, height);
+        if (offset + size > dataSize)
+            break;
+        m_levels.push_back({ width, height, offset, size });
+        offset += size;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+    m_data.assign(data, data + offset);
+}
+
+bool CompressedImage::LoadDds(const std::string& filepath, const std::vector<uint8_t>& file) {
+    // "DDS " + DDS_HEADER(124 bytes)
+    const size_t headerSize = 4 + 124;
+    if (file.size() < headerSize || ReadUint32(file.data()) != MakeFourCC("DDS ")) {
+        SPDLOG_ERROR("invalid dds file: {}", filepath);
+        return false;
+    }
+    const uint8_t* header = file.data() + 4;
+    m_height = (int)ReadUint32(header + 8);
+    m_width = (int)ReadUint32(header + 12);
+    size_t levelCount = std::max(ReadUint32(header + 24), 1u);
+    uint32_t fourCC = ReadUint32(header + 80);
+
+    size_t dataOffset = headerSize;
+    if (fourCC == MakeFourCC("DXT1"))
+        m_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    else if (fourCC == MakeFourCC("DXT5"))
+        m_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    else if (fourCC == MakeFourCC("ATI2") || fourCC == MakeFourCC("BC5U"))
+        m_format = GL_COMPRESSED_RG_RGTC2;
+    else if (fourCC == MakeFourCC("DX10")) {
+        // DDS_HEADER_DXT10(20 bytes), 첫 값이 DXGI_FORMAT
+        dataOffset += 20;
+        if (file.size() < dataOffset) {
+            SPDLOG_ERROR("invalid dds file: {}", filepath);
+            return false;
+        }
+        switch (ReadUint32(file.data() + headerSize)) {
+            case 71: m_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+            case 72: m_format = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; break;
+            case 77: m_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+            case 78: m_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+            case 83: m_format = GL_COMPRESSED_RG_RGTC2; break;
+            case 98: m_format = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+            case 99: m_format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+            default: break;
+        }
+    }
+    if (!m_format) {
+        SPDLOG_ERROR("unsupported dds format: {}", filepath);
+        return false;
+    }
+
+    AddLevels(file.data() + dataOffset, file.size() - dataOffset, levelCount);
+    if (m_levels.empty()) {
+        SPDLOG_ERROR("truncated dds file: {}", filepath);
+        return false;
+    }
+    return true;
+}
+
+bool CompressedImage::LoadKtx(const std::string& filepath, const std::vector<uint8_t>& file) {
+    const uint8_t identifier[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+    };
+    // identifier(12) + header 13 x uint32
+    const size_t headerSize = 12 + 13 * 4;
+    if (file.size() < headerSize || memcmp(file.data(), identifier, 12) != 0) {
+        SPDLOG_ERROR("invalid ktx file: {}", filepath);
+        return false;
+    }
+    const uint8_t* header = file.data() + 12;
+    if (ReadUint32(header) != 0x04030201) {
+        SPDLOG_ERROR("big endian ktx is not supported: {}", filepath);
+        return false;
+    }
+    m_format = ReadUint32(header + 16);     // glInternalFormat
+    m_width = (int)ReadUint32(header + 24);
+    m_height = (int)ReadUint32(header + 28);
+    size_t faceCount = ReadUint32(header + 40);
+    size_t levelCount = std::max(ReadUint32(header + 44), 1u);
+    size_t keyValueSize = ReadUint32(header + 48);
+    if (!GetBlockSize(m_format) || faceCount != 1) {
+        SPDLOG_ERROR("unsupported ktx format: {}", filepath);
+        return false;
+    }
+
+    // level마다 imageSize(uint32) + data, 4 byte 정렬
+    size_t offset = headerSize + keyValueSize;
+    int width = m_width;
+    int height = m_height;
+    for (size_t i = 0; i < levelCount && offset + 4 <= file.size(); i++) {
+        size_t size = ReadUint32(file.data() + offset);
+        offset += 4;
+        if (offset + size > file.size())
+            break;
+        m_levels.push_back({ width, height, m_data.size(), size });
+        m_data.insert(m_data.end(), file.data() + offset, file.data() + offset + size);
+        offset += (size + 3) & ~(size_t)3;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+    if (m_levels.empty()) {
+        SPDLOG_ERROR("truncated ktx file: {}", filepath);
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
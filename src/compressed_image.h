@@ -0,0 +1,73 @@
+#ifndef __COMPRESSED_IMAGE_H__
+#define __COMPRESSED_IMAGE_H__
+
+#include "common.h"
+#include <vector>
+
+// glad 설정에 따라 확장 enum이 없을 수 있다
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+// DDS / KTX(1) 파일에 미리 압축되어 있는 block compressed texture (BC1/BC3/BC5/BC7)
+// decode 없이 mip level 별 데이터를 그대로 glCompressedTexImage2D로 넘긴다
+CLASS_PTR(CompressedImage)
+class CompressedImage {
+public:
+    // 확장자(.dds / .ktx)로 container를 판단한다
+    static CompressedImageUPtr Load(const std::string& filepath);
+    // format을 현재 context가 지원하는지
+    static bool IsFormatSupported(uint32_t format);
+    // 같은 block 구조의 sRGB format, 없으면 그대로
+    static uint32_t GetSrgbFormat(uint32_t format);
+
+    struct Level {
+        int width { 0 };
+        int height { 0 };
+        size_t offset { 0 };
+        size_t size { 0 };
+    };
+
+    uint32_t GetFormat() const { return m_format; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    size_t GetLevelCount() const { return m_levels.size(); }
+    const Level& GetLevel(size_t level) const { return m_levels[level]; }
+    const uint8_t* GetLevelData(size_t level) const { return m_data.data() + m_levels[level].offset; }
+    size_t GetMemorySize() const { return m_data.size(); }
+
+private:
+    CompressedImage() {}
+    bool LoadDds(const std::string& filepath, const std::vector<uint8_t>& file);
+    bool LoadKtx(const std::string& filepath, const std::vector<uint8_t>& file);
+    void AddLevels(const uint8_t* data, size_t dataSize, size_t levelCount);
+
+    uint32_t m_format { 0 };
+    int m_width { 0 };
+    int m_height { 0 };
+    std::vector<Level> m_levels;
+    std::vector<uint8_t> m_data;
+};
+
+#endif // __COMPRESSED_IMAGE_H__
\ No newline at end of file
@@ -1,6 +1,26 @@
 #include "context.h"	
 #include "image.h"
 #include <imgui.h>
+#include <random>
+#include <unordered_map>
+#include <filesystem>
+#include <algorithm>
+#include <cfloat>
+
+// shadow quality별 shadow map 한 변의 크기
+static const int s_shadowMapSizes[] = { 512, 1024, 2048, 4096 };
+
+// reversed-Z용 먼 평면이 없는 원근 투영, glClipControl(GL_ZERO_TO_ONE)과 같이 쓴다
+// depth = near / 거리, near에서 1이고 멀어질수록 0에 가까워져 float depth의 정밀도가 먼 곳까지 고르게 간다
+static glm::mat4 ReversedInfinitePerspective(float fovy, float aspect, float zNear) {
+    float f = 1.0f / tanf(fovy * 0.5f);
+    glm::mat4 projection(0.0f);
+    projection[0][0] = f / aspect;
+    projection[1][1] = f;
+    projection[2][3] = -1.0f;
+    projection[3][2] = zNear;
+    return projection;
+}
 
 ContextUPtr Context::Create() {
     auto context = ContextUPtr(new Context());
@@ -16,21 +36,21 @@ void Context::ProcessInput(GLFWwindow* window) {
 
     const float cameraSpeed = 0.05f;
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        m_cameraPos += cameraSpeed * m_cameraFront;
+        m_cameraPos += glm::dvec3(cameraSpeed * m_cameraFront);
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        m_cameraPos -= cameraSpeed * m_cameraFront;
+        m_cameraPos -= glm::dvec3(cameraSpeed * m_cameraFront);
 
     auto cameraRight = glm::normalize(glm::cross(m_cameraUp, -m_cameraFront));   
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        m_cameraPos += cameraSpeed * cameraRight;
+        m_cameraPos += glm::dvec3(cameraSpeed * cameraRight);
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        m_cameraPos -= cameraSpeed * cameraRight;    
+        m_cameraPos -= glm::dvec3(cameraSpeed * cameraRight);    
 
     auto cameraUp = glm::normalize(glm::cross(-m_cameraFront, cameraRight));    
     if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-        m_cameraPos += cameraSpeed * cameraUp;
+        m_cameraPos += glm::dvec3(cameraSpeed * cameraUp);
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-        m_cameraPos -= cameraSpeed * cameraUp;
+        m_cameraPos -= glm::dvec3(cameraSpeed * cameraUp);
 }
 
 void Context::Reshape(int width, int height) {
@@ -38,7 +58,19 @@ void Context::Reshape(int width, int height) {
     m_height = height;
     glViewport(0, 0, m_width, m_height);
 
-    m_framebuffer = Framebuffer::Create(Texture::Create(width, height, GL_RGBA));
+    if (m_reversedZ) {
+        // linear로 그린 색을 화면에 옮길 때 sRGB로 encode 하므로 float color
+        m_framebuffer = Framebuffer::Create(Texture::Create(width, height, GL_RGBA16F));
+        m_sceneFramebuffer = Framebuffer::CreateMultisample(width, height, 4,
+            GL_RGBA16F, GL_DEPTH32F_STENCIL8);
+    }
+    else
+        m_framebuffer = Framebuffer::Create(Texture::Create(width, height, GL_RGBA8));
+    // feedback은 화면의 1/8 해상도로 충분하다
+    // 같은 projection으로 그리므로 depth 형식도 main pass와 맞춘다
+    if (!m_virtualTextures.empty())
+        m_vtFeedback = VirtualTextureFeedback::Create(width / 8, height / 8,
+            m_reversedZ ? GL_DEPTH32F_STENCIL8 : GL_DEPTH24_STENCIL8);
 }
 
 void Context::MouseMove(double x, double y) {
@@ -73,15 +105,55 @@ void Context::MouseButton(int button, int action, double x, double y) {
     }
 }
 
+// image/earth.jpg 옆에 미리 변환해 둔 같은 이름의 .ktx / .dds 파일
+static std::string FindCompressedTexture(const std::string& filename) {
+    auto basename = filename.substr(0, filename.find_last_of('.'));
+    for (auto extension: { ".ktx", ".dds" }) {
+        if (std::filesystem::exists(basename + extension))
+            return basename + extension;
+    }
+    return std::string();
+}
+
 bool Context::Init() {
+    double initStartTime = glfwGetTime();
     glEnable(GL_MULTISAMPLE);
+    m_reversedZ = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_clip_control;
+    SPDLOG_INFO("reversed-Z depth: {}", m_reversedZ ? "enabled" : "not supported");
+
+    // image decode는 worker thread에서 shader compile과 동시에 진행하고
+    // texture 생성(GL 호출)만 여기서 결과를 받아 처리한다
+    m_threadPool = ThreadPool::Create();
+    m_clock = SimulationClock::Create();
+    m_nbody = NBodySimulation::Create(m_threadPool.get());
+    m_textureCache = TextureCache::Create();
+    std::unordered_map<std::string, std::future<ImageUPtr>> images;
+    auto LoadImageAsync = [&](const std::string& filename, bool flipVertical) {
+        images[filename] = m_threadPool->Submit([filename, flipVertical]() {
+            return Image::Load(filename, flipVertical);
+        });
+    };
+    for (auto name: { "sun", "mercury", "venus", "earth", "moon", "mars" }) {
+        auto filename = fmt::format("./image/{}.jpg", name);
+        if (FindCompressedTexture(filename).empty())
+            LoadImageAsync(filename, true);
+    }
+    for (auto face: { "right", "left", "top", "bottom", "front", "back" })
+        LoadImageAsync(fmt::format("./image/space/{}.png", face), false);
+
     m_box = Mesh::CreateBox();
     m_plane = Mesh::CreatePlane();
-    m_sphere = Mesh::CreateSphere();
+    // 천체 구는 vertex 수가 많으므로 compact vertex format으로 올린다
+    m_sphereLod = MeshLod::CreateSphere(8, 256, VertexFormat::CompactQuantized);
+    m_sphere = m_sphereLod->GetMesh(1);
+    m_asteroid = Mesh::CreateSphere(6, 12, VertexFormat::CompactQuantized);
+    m_instanceBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW,
+        nullptr, sizeof(glm::mat4), 0);
 
     m_simpleProgram = Program::Create("./shader/simple.vs", "./shader/simple.fs");
     if (!m_simpleProgram)
         return false;
+    m_simpleUniforms = ProgramUniforms::Find(m_simpleProgram.get());
 
     m_program = Program::Create("./shader/lighting.vs", "./shader/lighting.fs");
     if (!m_program)
@@ -94,6 +166,7 @@ bool Context::Init() {
     m_postProgram = Program::Create("./shader/texture.vs","./shader/gamma.fs");
     if (!m_postProgram)
         return false;
+    m_postUniforms = ProgramUniforms::Find(m_postProgram.get());
 
     glClearColor(0.0f, 0.5f, 1.0f, 0.0f);
     
@@ -103,43 +176,139 @@ bool Context::Init() {
     TexturePtr grayTexture = Texture::CreateFromImage(
         Image::CreateSingleColorImage(4, 4, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f)).get());
 
-    // 태양계 texture
-    m_sunMaterial = Material::Create();
-    m_sunMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/sun.jpg").get());
-    m_sunMaterial->specular = grayTexture;
-    m_sunMaterial->shininess = 64.0f;
-
-    m_mercuryMaterial = Material::Create();
-    m_mercuryMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/mercury.jpg").get());
-    m_mercuryMaterial->specular = grayTexture;
-    m_mercuryMaterial->shininess = 16.0f;
-
-    m_venusMaterial = Material::Create();
-    m_venusMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/venus.jpg").get());
-    m_venusMaterial->specular = grayTexture;
-    m_venusMaterial->shininess = 16.0f;
-
-    m_earthMaterial = Material::Create();
-    m_earthMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/earth.jpg").get());
-    m_earthMaterial->specular = grayTexture;
-    m_earthMaterial->shininess = 16.0f;
-
-    m_moonMaterial = Material::Create();
-    m_moonMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/moon.jpg").get());
-    m_moonMaterial->specular = grayTexture;
-    m_moonMaterial->shininess = 16.0f;
-
-    m_marsMaterial = Material::Create();
-    m_marsMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/mars.jpg").get());
-    m_marsMaterial->specular = grayTexture;
-    m_marsMaterial->shininess = 16.0f;
-
-    auto cubeRight = Image::Load("./image/space/right.png", false);
-    auto cubeLeft = Image::Load("./image/space/left.png", false);
-    auto cubeTop = Image::Load("./image/space/top.png", false);
-    auto cubeBottom = Image::Load("./image/space/bottom.png", false);
-    auto cubeFront = Image::Load("./image/space/front.png", false);
-    auto cubeBack = Image::Load("./image/space/back.png", false);
+    // 태양계 texture, decode가 끝나는 대로 texture uploader로 여러 프레임에 나눠 올리고
+    // 그 전까지는 회색 texture로 그린다
+    m_textureUploader = TextureUploader::Create();
+    if (!m_textureUploader)
+        return false;
+    auto CreatePlanetMaterial = [&](const std::string& filename, float shininess) -> MaterialPtr {
+        MaterialPtr material = Material::Create();
+        material->diffuse = darkGrayTexture;
+        material->specular = grayTexture;
+        material->shininess = shininess;
+        auto compressedFilename = FindCompressedTexture(filename);
+        auto compressed = compressedFilename.empty() ?
+            nullptr : m_textureCache->Load(compressedFilename, true);
+        if (compressed) {
+            material->diffuse = compressed;
+            return material;
+        }
+        if (images.find(filename) == images.end())
+            LoadImageAsync(filename, true);
+        m_pendingTextures.push_back({ filename, std::move(images[filename]), { material } });
+        return material;
+    };
+
+    // 태양을 중심으로 한 천체 테이블, 부모 천체를 먼저 추가해야 한다
+    m_bodies = CelestialBodyTable::Create(glm::dvec3(m_light.position));
+    CelestialBody body;
+    body.name = "sun";
+    body.scale = 5.0f;
+    body.spinRate = 14.4f;
+    body.castsShadow = false;
+    body.mass = 1.0f;
+    body.mesh = m_sphere;
+    body.material = CreatePlanetMaterial("./image/sun.jpg", 64.0f);
+    int sun = m_bodies->AddBody(body);
+
+    body = CelestialBody();
+    body.name = "mercury";
+    body.scale = 0.5f;
+    body.orbitRadius = 5.0f;
+    body.orbitPeriod = 88.0f;
+    body.eccentricity = 0.206f;
+    body.inclination = glm::radians(7.0f);
+    body.ascendingNode = glm::radians(48.3f);
+    body.argumentOfPeriapsis = glm::radians(29.1f);
+    body.mass = 1.7e-7f;
+    body.spinRate = 6.1f;
+    body.parent = sun;
+    body.mesh = m_sphere;
+    body.material = CreatePlanetMaterial("./image/mercury.jpg", 16.0f);
+    m_bodies->AddBody(body);
+
+    body = CelestialBody();
+    body.name = "venus";
+    body.scale = 1.0f;
+    body.orbitRadius = 7.0f;
+    body.orbitPeriod = 225.0f;
+    body.eccentricity = 0.007f;
+    body.inclination = glm::radians(3.4f);
+    body.ascendingNode = glm::radians(76.7f);
+    body.argumentOfPeriapsis = glm::radians(54.9f);
+    body.mass = 2.4e-6f;
+    body.spinRate = -1.48f;
+    body.spinAxis = glm::vec3(0.0f, 1.0f, 1.0f);
+    body.parent = sun;
+    body.mesh = m_sphere;
+    body.material = CreatePlanetMaterial("./image/venus.jpg", 16.0f);
+    m_bodies->AddBody(body);
+
+    body = CelestialBody();
+    body.name = "earth";
+    body.scale = 1.2f;
+    body.orbitRadius = 9.0f;
+    body.orbitPeriod = 365.0f;
+    body.eccentricity = 0.017f;
+    body.argumentOfPeriapsis = glm::radians(114.2f);
+    // 실제 질량(3e-6)이면 반경 1.0의 달이 Hill 반경 밖이라 떨어져 나가므로 무겁게 둔다
+    body.mass = 0.03f;
+    body.spinRate = 360.0f;
+    body.spinAxis = glm::vec3(0.0f, 1.0f, 0.2f);
+    body.parent = sun;
+    body.mesh = m_sphere;
+    body.material = CreatePlanetMaterial("./image/earth.jpg", 16.0f);
+    int earth = m_bodies->AddBody(body);
+
+    body = CelestialBody();
+    body.name = "moon";
+    body.scale = 0.2f;
+    body.orbitRadius = 1.0f;
+    body.orbitPeriod = 27.0f;
+    body.eccentricity = 0.055f;
+    body.inclination = glm::radians(5.1f);
+    body.mass = 3.7e-7f;
+    body.spinRate = 13.3f;
+    body.parent = earth;
+    body.mesh = m_sphere;
+    body.material = CreatePlanetMaterial("./image/moon.jpg", 16.0f);
+    m_bodies->AddBody(body);
+    m_asteroidMaterial = body.material;
+
+    body = CelestialBody();
+    body.name = "mars";
+    body.scale = 0.8f;
+    body.orbitRadius = 12.0f;
+    body.orbitPeriod = 687.0f;
+    body.eccentricity = 0.093f;
+    body.inclination = glm::radians(1.85f);
+    body.ascendingNode = glm::radians(49.6f);
+    body.argumentOfPeriapsis = glm::radians(286.5f);
+    body.mass = 3.2e-7f;
+    body.spinRate = 360.0f;
+    body.parent = sun;
+    body.mesh = m_sphere;
+    body.material = CreatePlanetMaterial("./image/mars.jpg", 16.0f);
+    m_bodies->AddBody(body);
+    m_planetCount = m_bodies->GetCount();
+
+    // tools/page_file_builder로 만든 ./image/<name>.vt가 있으면 virtual texture로 그린다
+    for (size_t i = 0; i < m_planetCount; i++) {
+        auto filename = fmt::format("./image/{}.vt", m_bodies->GetName(i));
+        if (m_virtualTextures.size() >= 15 || !std::filesystem::exists(filename))
+            continue;
+        auto texture = VirtualTexture::Create(filename);
+        if (texture)
+            m_virtualTextures.push_back({ m_bodies->GetName(i), m_bodies->GetMaterial(i), std::move(texture) });
+    }
+    SetAsteroidCount(m_asteroidCount);
+
+    auto cubeRight = images["./image/space/right.png"].get();
+    auto cubeLeft = images["./image/space/left.png"].get();
+    auto cubeTop = images["./image/space/top.png"].get();
+    auto cubeBottom = images["./image/space/bottom.png"].get();
+    auto cubeFront = images["./image/space/front.png"].get();
+    auto cubeBack = images["./image/space/back.png"].get();
     m_cubeTexture = CubeTexture::CreateFromImages({
         cubeRight.get(),
         cubeLeft.get(),
@@ -147,280 +316,784 @@ bool Context::Init() {
         cubeBottom.get(),
         cubeFront.get(),
         cubeBack.get(),
-    });
+    }, true);
     m_skyboxProgram = Program::Create("./shader/skybox.vs", "./shader/skybox.fs");
+    if (!m_skyboxProgram)
+        return false;
+    m_skyboxUniforms = ProgramUniforms::Find(m_skyboxProgram.get());
     m_envMapProgram = Program::Create("./shader/env_map.vs", "./shader/env_map.fs");
 
-    m_shadowMap = ShadowMap::Create(1024, 1024);
-    m_lightingShadowProgram = Program::Create("./shader/lighting_shadow.vs", "./shader/lighting_shadow.fs");
+    // 처음부터 설정된 quality의 해상도로 만든다
+    int shadowMapSize = s_shadowMapSizes[m_shadowQuality];
+    m_shadowMap = ShadowMap::Create(shadowMapSize, shadowMapSize);
+    m_shadowCubeMap = ShadowMap::CreateCube(shadowMapSize);
+    if (!m_shadowMap || !m_shadowCubeMap)
+        return false;
+    m_shadowInstanceBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW,
+        nullptr, sizeof(glm::mat4), 0);
+    m_shadowProgram = Program::Create("./shader/shadow_depth.vs", "./shader/shadow_depth.fs");
+    if (!m_shadowProgram)
+        return false;
+    m_shadowUniforms = ProgramUniforms::Find(m_shadowProgram.get());
+    if (!CreateLightingProgram())
+        return false;
+    if (!m_virtualTextures.empty()) {
+        m_vtFeedbackProgram = Program::Create("./shader/lighting_shadow.vs", "./shader/vt_feedback.fs");
+        if (!m_vtFeedbackProgram)
+            return false;
+        m_vtFeedbackProgram->BindUniformBlock("PerFrame", PerFrameBlockBinding);
+        m_vtFeedbackProgram->BindUniformBlock("Lights", LightsBlockBinding);
+        m_vtFeedbackUniforms = ProgramUniforms::Find(m_vtFeedbackProgram.get());
+    }
 
+    m_perFrameBuffer = Buffer::CreateWithData(GL_UNIFORM_BUFFER, GL_DYNAMIC_DRAW,
+        nullptr, sizeof(PerFrameBlock), 1);
+    m_perFrameBuffer->BindBase(PerFrameBlockBinding);
+    m_lightsBuffer = Buffer::CreateWithData(GL_UNIFORM_BUFFER, GL_DYNAMIC_DRAW,
+        nullptr, sizeof(LightsBlock), 1);
+    m_lightsBuffer->BindBase(LightsBlockBinding);
+    for (auto program: { m_simpleProgram.get(), m_skyboxProgram.get() }) {
+        program->BindUniformBlock("PerFrame", PerFrameBlockBinding);
+        program->BindUniformBlock("Lights", LightsBlockBinding);
+    }
+
+    // cache miss가 하나라도 있으면 cold start
+    auto& cacheStats = Program::GetCacheStats();
+    SPDLOG_INFO("{} start: {:.1f} ms (programs {:.1f} ms, cached {}, compiled {})",
+        cacheStats.misses > 0 ? "cold" : "warm",
+        (glfwGetTime() - initStartTime) * 1000.0, cacheStats.seconds * 1000.0,
+        cacheStats.hits, cacheStats.misses);
     return true;
 }
 
+// PCF tap 수가 바뀌면 shader를 다시 compile해야 하므로 따로 분리
+bool Context::CreateLightingProgram() {
+    const int pcfTaps[] = { 1, 4, 16 };
+    auto program = Program::Create("./shader/lighting_shadow.vs", "./shader/lighting_shadow.fs",
+        { fmt::format("SHADOW_PCF_TAPS {}", pcfTaps[m_shadowPcfKernel]) });
+    if (!program)
+        return false;
+    program->BindUniformBlock("PerFrame", PerFrameBlockBinding);
+    program->BindUniformBlock("Lights", LightsBlockBinding);
+    m_lightingUniforms = ProgramUniforms::Find(program.get());
+    m_lightingShadowProgram = std::move(program);
+
+    if (m_virtualTextures.empty())
+        return true;
+    program = Program::Create("./shader/lighting_shadow.vs", "./shader/lighting_shadow.fs",
+        { fmt::format("SHADOW_PCF_TAPS {}", pcfTaps[m_shadowPcfKernel]), "VIRTUAL_TEXTURE" });
+    if (!program)
+        return false;
+    program->BindUniformBlock("PerFrame", PerFrameBlockBinding);
+    program->BindUniformBlock("Lights", LightsBlockBinding);
+    m_vtLightingUniforms = ProgramUniforms::Find(program.get());
+    program->Use();
+    program->SetUniform(m_vtLightingUniforms.shadowMap, 3);
+    program->SetUniform(m_vtLightingUniforms.shadowCubeMap, 4);
+    m_vtLightingProgram = std::move(program);
+    return true;
+}
+
+Context::ProgramUniforms Context::ProgramUniforms::Find(const Program* program) {
+    ProgramUniforms uniforms;
+    uniforms.transform = program->GetUniformId("transform");
+    uniforms.modelTransform = program->GetUniformId("modelTransform");
+    uniforms.color = program->GetUniformId("color");
+    uniforms.skybox = program->GetUniformId("skybox");
+    uniforms.tex = program->GetUniformId("tex");
+    uniforms.gamma = program->GetUniformId("gamma");
+    uniforms.shadowMap = program->GetUniformId("shadowMap");
+    uniforms.shadowCubeMap = program->GetUniformId("shadowCubeMap");
+    uniforms.vtId = program->GetUniformId("vtId");
+    uniforms.vtFeedbackBias = program->GetUniformId("vtFeedbackBias");
+    uniforms.mesh = MeshUniforms::Find(program);
+    uniforms.virtualTexture = VirtualTextureUniforms::Find(program);
+    return uniforms;
+}
+
+int Context::FindVirtualTexture(const Material* material) const {
+    for (size_t i = 0; i < m_virtualTextures.size(); i++) {
+        if (m_virtualTextures[i].material.get() == material)
+            return (int)i;
+    }
+    return -1;
+}
+
+// 이전 프레임 feedback으로 tile을 올리고, 이번 프레임에 보이는 tile을 기록한다
+void Context::RenderVirtualTextureFeedback() {
+    if (!m_virtualTexturing || !m_vtFeedback)
+        return;
+    std::vector<VirtualTexture*> textures;
+    for (auto& entry: m_virtualTextures)
+        textures.push_back(entry.texture.get());
+    m_vtFeedback->Resolve(textures);
+    for (auto texture: textures)
+        texture->Update(m_vtUploadsPerFrame);
+
+    m_vtFeedback->Begin();
+    m_vtFeedbackProgram->Use();
+    m_vtFeedbackProgram->SetUniform(m_vtFeedbackUniforms.vtFeedbackBias,
+        -log2f((float)m_width / (float)m_vtFeedback->GetWidth()));
+    for (auto& batch: m_visibleBatches) {
+        int id = FindVirtualTexture(batch.material.get());
+        if (id < 0)
+            continue;
+        textures[id]->SetToProgram(m_vtFeedbackProgram.get(),
+            m_vtFeedbackUniforms.virtualTexture, 5, 6);
+        m_vtFeedbackProgram->SetUniform(m_vtFeedbackUniforms.vtId, id);
+        batch.mesh->DrawInstanced(m_vtFeedbackProgram.get(), m_vtFeedbackUniforms.mesh,
+            m_instanceBuffer.get(),
+            batch.first, batch.count);
+    }
+    m_vtFeedback->End();
+    glViewport(0, 0, m_width, m_height);
+}
+
+// 다른 thread에서 decode한 뒤 stream upload로 교체한다 (고해상도 texture 교체용)
+void Context::LoadBodyTexture(int bodyIndex, const std::string& filename) {
+    if (bodyIndex < 0 || bodyIndex >= (int)m_bodies->GetCount())
+        return;
+    auto material = m_bodies->GetMaterial(bodyIndex);
+    // 압축 texture는 decode할 필요가 없으므로 바로 교체
+    auto extension = filename.substr(filename.find_last_of('.') + 1);
+    if (extension == "dds" || extension == "ktx") {
+        auto texture = m_textureCache->Load(filename, true);
+        if (texture)
+            material->diffuse = texture;
+        return;
+    }
+    // 이미 올라가 있거나 decode 중인 파일이면 그 결과를 같이 쓴다
+    auto texture = m_textureCache->Find(filename, true);
+    if (texture) {
+        material->diffuse = texture;
+        return;
+    }
+    for (auto& pending: m_pendingTextures) {
+        if (pending.filename == filename) {
+            pending.materials.push_back(material);
+            return;
+        }
+    }
+    auto image = m_threadPool->Submit([filename]() { return Image::Load(filename); });
+    m_pendingTextures.push_back({ filename, std::move(image), { material } });
+}
+
+void Context::UpdateTextureStreaming() {
+    for (auto it = m_pendingTextures.begin(); it != m_pendingTextures.end();) {
+        if (it->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+        auto cache = m_textureCache.get();
+        m_textureUploader->Upload(it->image.get(), true,
+            [cache, filename = it->filename, materials = it->materials](TexturePtr texture) {
+                cache->Insert(filename, true, true, texture);
+                for (auto& material: materials)
+                    material->diffuse = texture;
+            });
+        it = m_pendingTextures.erase(it);
+    }
+    m_textureUploader->Update((size_t)m_textureUploadBudget << 20);
+}
+
 void Context::Render() { 
     const char* s_planet[] = {"solarsystem","sun","mercury","venus","earth","moon","mars"};
     static int planet_current = 0;
+    // 지난 프레임 동안 glGetUniformLocation 없이 처리된 uniform 수
+    m_uniformStats = Program::GetUniformStats();
+    Program::ResetUniformStats();
     if (ImGui::Begin("UI Window")) {
         if(ImGui::ColorEdit4("Clear Color", glm::value_ptr(m_clearColor))){
             glClearColor(m_clearColor.r, m_clearColor.g, m_clearColor.b,m_clearColor.a);
         }
-        ImGui::DragFloat("gamma", &m_gamma, 0.01f, 0.0f, 2.0f);
+        // gamma는 scene framebuffer를 화면으로 옮기는 post pass에서만 적용된다
+        if (m_reversedZ && m_sceneFramebuffer)
+            ImGui::DragFloat("gamma", &m_gamma, 0.01f, 0.0f, 2.0f);
         ImGui::Separator();
-        ImGui::DragFloat3("Camera Pos", glm::value_ptr(m_cameraPos), 0.01f);
+        ImGui::DragScalarN("Camera Pos", ImGuiDataType_Double, glm::value_ptr(m_cameraPos), 3, 0.01f);
         ImGui::DragFloat("Camera Yaw", &m_cameraYaw, 0.5f);
         ImGui::DragFloat("Camera Pitch", &m_cameraPitch, 0.5f, -89.0f, 89.0f);
         ImGui::Separator();
         if (ImGui::Button("Reset Camera")) {
             m_cameraYaw = 0.0f;
             m_cameraPitch = -89.0f;
-            m_cameraPos = glm::vec3(5.0f, 20.0f, 0.0f);
+            m_cameraPos = glm::dvec3(5.0, 20.0, 0.0);
         } 	 	
         ImGui::Combo("SelectPlanet", &planet_current, s_planet, IM_ARRAYSIZE(s_planet));
         ImGui::Checkbox("rotating", &m_rotating);
         ImGui::Checkbox("revolution", &m_revolution);
+        if (ImGui::Checkbox("n-body physics", &m_physics) && m_physics)
+            ResetPhysics();
+        if (m_physics) {
+            float theta = m_nbody->GetTheta();
+            if (ImGui::SliderFloat("barnes-hut theta", &theta, 0.1f, 0.55f))
+                m_nbody->SetTheta(theta);
+            auto& nbodyStats = m_nbody->GetStats();
+            ImGui::Text("n-body: %d nodes, tree %.2f ms, force %.2f ms",
+                (int)nbodyStats.nodeCount, nbodyStats.buildMs, nbodyStats.forceMs);
+        }
+        const char* timeScales[] = { "paused", "1 s = 1 day", "1 s = 1 week", "1 s = 1 month", "1 s = 1 year" };
+        const double daysPerSecond[] = { 0.0, 1.0, 7.0, 30.0, 365.25 };
+        if (ImGui::Combo("time scale", &m_timeScaleIndex, timeScales, IM_ARRAYSIZE(timeScales))) {
+            m_clock->SetPaused(m_timeScaleIndex == 0);
+            if (m_timeScaleIndex > 0)
+                m_clock->SetTimeScale(daysPerSecond[m_timeScaleIndex]);
+        }
+        ImGui::Text("simulation day %.2f (%.2f years), %d steps/frame",
+            m_clock->GetTime(), m_clock->GetTime() / 365.25, m_simulationSteps);
+        ImGui::Checkbox("omni shadow", &m_omniShadow);
+        const char* shadowQualities[] = { "512", "1024", "2048", "4096" };
+        if (ImGui::Combo("shadow quality", &m_shadowQuality,
+            shadowQualities, IM_ARRAYSIZE(shadowQualities)))
+            SetShadowQuality(m_shadowQuality);
+        const char* pcfKernels[] = { "1 tap", "4 tap poisson", "16 tap poisson" };
+        if (ImGui::Combo("shadow PCF", &m_shadowPcfKernel, pcfKernels, IM_ARRAYSIZE(pcfKernels)))
+            CreateLightingProgram();
+        ImGui::Text("shadow map memory: %.1f MB",
+            (m_shadowMap->GetMemorySize() + m_shadowCubeMap->GetMemorySize()) / (1024.0f * 1024.0f));
+        ImGui::Text("shadow casters drawn: %d", (int)m_shadowInstanceData.size());
+        if (ImGui::DragInt("asteroids", &m_asteroidCount, 100.0f, 0, 100000))
+            SetAsteroidCount(m_asteroidCount);
+        ImGui::DragInt("texture upload MB/frame", &m_textureUploadBudget, 0.2f, 1, 64);
+        static char textureFilename[256] = "./image/earth.jpg";
+        ImGui::InputText("texture file", textureFilename, sizeof(textureFilename));
+        if (ImGui::Button("load texture to selected planet") && planet_current > 0)
+            LoadBodyTexture(m_bodies->FindBody(s_planet[planet_current]), textureFilename);
+        ImGui::Text("texture streaming: %d decoding, %d uploading (%.1f MB)",
+            (int)m_pendingTextures.size(), (int)m_textureUploader->GetPendingCount(),
+            m_textureUploader->GetPendingBytes() / (1024.0f * 1024.0f));
+        auto& cacheStats = m_textureCache->GetStats();
+        ImGui::Text("texture cache: %d live, %u hits, %u misses, %.1f MB saved",
+            (int)m_textureCache->GetLiveCount(), cacheStats.hits, cacheStats.misses,
+            cacheStats.bytesSaved / (1024.0f * 1024.0f));
+        if (!m_virtualTextures.empty()) {
+            ImGui::Checkbox("virtual texture", &m_virtualTexturing);
+            ImGui::DragInt("vt uploads/frame", &m_vtUploadsPerFrame, 0.2f, 1, 256);
+            for (auto& entry: m_virtualTextures) {
+                auto& texture = entry.texture;
+                ImGui::Text("vt %s: %d/%d pages, %d requested, %d uploaded", entry.name.c_str(),
+                    texture->GetResidentCount(), texture->GetSlotCount(),
+                    texture->GetRequestCount(), texture->GetUploadCount());
+            }
+        }
+        ImGui::Checkbox("frustum culling", &m_frustumCulling);
+        ImGui::Text("culling: %d / %d visible, %d culled, %.3f ms",
+            m_cullStats.visible, m_cullStats.tested,
+            m_cullStats.tested - m_cullStats.visible, m_cullStats.cullMs);
+        ImGui::Text("draw calls: %d", (int)m_visibleBatches.size());
+        ImGui::DragFloat("lod pixel error", &m_lodPixelError, 0.05f, 0.1f, 16.0f);
+        size_t triangleCount = 0;
+        for (auto& batch: m_visibleBatches)
+            triangleCount += batch.count * batch.mesh->GetIndexCount() / 3;
+        ImGui::Text("triangles: %d", (int)triangleCount);
+        ImGui::Text("geometry pools: %d (%.1f MB)", (int)GeometryPool::GetPoolCount(),
+            GeometryPool::GetTotalMemorySize() / (1024.0f * 1024.0f));
+        auto& cacheBefore = m_sphere->GetCacheStatsBefore();
+        auto& cacheAfter = m_sphere->GetCacheStats();
+        ImGui::Text("sphere ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            cacheBefore.acmr, cacheAfter.acmr, cacheBefore.atvr, cacheAfter.atvr);
+        // 이름으로 설정하면 여전히 hash를 계산하므로 id로 설정한 것만 줄어든 lookup이다
+        ImGui::Text("uniform lookups eliminated: %u, by name: %u",
+            m_uniformStats.idLookups, m_uniformStats.nameLookups);
     }
     ImGui::End(); 	
 
-    auto lightView = glm::lookAt(m_light.position,
-        m_light.position + m_light.direction,
-        glm::vec3(0.0f, 1.0f, 0.0f));  	
- 
-    m_shadowMap->Bind();
-    glClear(GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0,
-        m_shadowMap->GetShadowMap()->GetWidth(),
-        m_shadowMap->GetShadowMap()->GetHeight());
-    m_simpleProgram->Use();
-    m_simpleProgram->SetUniform("color", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-
-    Framebuffer::BindToDefault();
-    glViewport(0, 0, m_width, m_height);
- 	
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-	
+    UpdateTextureStreaming();
+
+    // 공전/자전은 프레임당 한 번만 계산하고 DrawScene과 카메라가 같이 사용한다
+    // 시간은 프레임마다 한 번만 읽고, 그리는 값은 fixed step 사이를 보간한 시간
+    m_simulationSteps = m_clock->Advance(glfwGetTime());
+    if (m_physics) {
+        // 물리 모드는 step 사이를 보간하지 않고 마지막 상태를 그린다
+        if (m_revolution)
+            StepPhysics(m_simulationSteps);
+        m_nbody->GetPositions(m_physicsPositions.data());
+        m_bodies->Update(m_clock->GetInterpolatedTime(), m_physicsPositions.data(), m_rotating);
+    }
+    else
+        m_bodies->Update(m_clock->GetInterpolatedTime(), m_revolution, m_rotating);
+    if (planet_current > 0)
+        FocusCamera(m_bodies->FindBody(s_planet[planet_current]));
+    // 이후의 모든 위치는 카메라 기준, 카메라가 원점이므로 view는 회전만 남는다
+    m_bodies->UpdateTransforms(m_cameraPos);
+    glm::vec3 lightPosition = glm::vec3(glm::dvec3(m_light.position) - m_cameraPos);
+    UpdateLod();
+    UpdateInstances();
+
+    // shadow pass
+    auto lightView = glm::lookAt(lightPosition,
+        lightPosition + m_light.direction,
+        glm::vec3(0.0f, 1.0f, 0.0f));
+    auto lightProjection = glm::perspective(glm::radians(90.0f), 1.0f,
+        m_light.shadowNearPlane, m_light.shadowFarPlane);
+    auto lightTransform = lightProjection * lightView;
+    RenderShadowMap(lightTransform, lightPosition);
+
     m_cameraFront =
         glm::rotate(glm::mat4(1.0f), glm::radians(m_cameraYaw), glm::vec3(0.0f, 1.0f, 0.0f)) *
         glm::rotate(glm::mat4(1.0f), glm::radians(m_cameraPitch), glm::vec3(1.0f, 0.0f, 0.0f)) *
         glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
 
-    auto projection = glm::perspective(glm::radians(45.0f),
-        (float)m_width / (float)m_height, 0.01f, 100.0f); //어디서 어디까지보여주는지 결정해주는것
-
-    auto view = glm::lookAt(m_cameraPos, m_cameraPos + m_cameraFront, m_cameraUp);  
-
-    //공전 
-    const float pi = 3.141592f;
-    float mercury_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 88.0f);
-    float mercury_x = cos(mercury_Rangle) * 5.0f;
-    float mercury_z = sin(mercury_Rangle) * 5.0f;
-    float venus_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 225.0f);
-    float venus_x = cos(venus_Rangle) * 7.0f;
-    float venus_z = sin(venus_Rangle) * 7.0f;
-    float earth_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 365.0f); 
-    float earth_x = cos(earth_Rangle) * 9.0f;
-    float earth_z = sin(earth_Rangle) * 9.0f;
-    float mars_Rngle = (360.f / 180.0f * (float)glfwGetTime() * pi / 687.0f);
-    float mars_x = cos(mars_Rngle) * 12.0f;
-    float mars_z = sin(mars_Rngle) * 12.0f;
-    float moon_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 27.0f);
-    float moon_x = earth_x + cos(moon_Rangle) * 1.0f;
-    float moon_z = earth_z + sin(moon_Rangle) * 1.0f;
-    if(!m_revolution){
-        mercury_x = 5.0f;
-        mercury_z = 0.0f;
-        venus_x = 7.0f;
-        venus_z = 0.0f;
-        earth_x = 9.0f;
-        earth_z = 0.0f;
-        mars_x = 12.0f;
-        mars_z = 0.0f;
-        moon_x = 10.0f;
-        moon_z = 0.0f;
-    }
-    if(planet_current == 1){
-        m_cameraPos = glm::vec3(0.0f, 15.0f, 0.0f);
-        m_cameraPitch = -89.0f;
-    }
-    else if(planet_current == 2){
-        m_cameraPos = glm::vec3(mercury_x + 0.5f, 5.0f, mercury_z + 0.5f);
-        m_cameraYaw = 45.0f;
-        m_cameraPitch = 0.0f;
-    }
-    else if(planet_current == 3){
-        m_cameraPos = glm::vec3(venus_x + 1.0f, 5.0f, venus_z + 1.0f);
-        m_cameraYaw = 45.0f;
-        m_cameraPitch = 0.0f;
-    }
-    else if(planet_current == 4){
-        m_cameraPos = glm::vec3(earth_x + 1.2f, 5.0f, earth_z + 1.2f);
-        m_cameraYaw = 45.0f;
-        m_cameraPitch = 0.0f;
-    }
-    else if(planet_current == 5){
-        m_cameraPos = glm::vec3(moon_x - 0.2f, 5.0f, moon_z - 0.2f);
-        m_cameraYaw = 225.0f;
-        m_cameraPitch = 0.0f;
-    }
-    else if(planet_current == 6){
-        m_cameraPos = glm::vec3(mars_x + 1.0f, 5.0f, mars_z + 1.0f);
-        m_cameraYaw = 45.0f;
-        m_cameraPitch = 0.0f;
+    // 먼 평면이 없는 projection, reversed-Z이면 가까울수록 depth가 1에 가깝다
+    bool reversedZ = m_reversedZ && m_sceneFramebuffer;
+    float aspect = (float)m_width / (float)m_height;
+    auto projection = reversedZ ?
+        ReversedInfinitePerspective(glm::radians(m_cameraFov), aspect, m_cameraNearPlane) :
+        glm::infinitePerspective(glm::radians(m_cameraFov), aspect, m_cameraNearPlane);
+    auto view = glm::lookAt(glm::vec3(0.0f), m_cameraFront, m_cameraUp);
+    CullInstances(projection * view);
+
+    // 모든 program이 공유하는 카메라/조명 값은 uniform buffer로 한 번에 올린다
+    PerFrameBlock perFrame;
+    perFrame.view = view;
+    perFrame.projection = projection;
+    perFrame.viewProjection = projection * view;
+    perFrame.viewPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    m_perFrameBuffer->Update(&perFrame, 1);
+
+    LightsBlock lights;
+    lights.lightTransform = lightTransform;
+    lights.position = glm::vec4(lightPosition, 1.0f);
+    lights.direction = glm::vec4(m_light.direction, 0.0f);
+    lights.attenuation = glm::vec4(GetAttenuationCoeff(m_light.distance), 0.0f);
+    lights.ambient = glm::vec4(m_light.ambient, 1.0f);
+    lights.diffuse = glm::vec4(m_light.diffuse, 1.0f);
+    lights.specular = glm::vec4(m_light.specular, 1.0f);
+    lights.shadowNearPlane = m_light.shadowNearPlane;
+    lights.shadowFarPlane = m_light.shadowFarPlane;
+    lights.omniShadow = m_omniShadow ? 1 : 0;
+    m_lightsBuffer->Update(&lights, 1);
+
+    // shadow map은 일반 depth 그대로, 카메라 projection을 쓰는 pass만 reversed-Z로 그린다
+    // vt feedback pass도 같은 projection이므로 여기서 설정한 clear 값과 비교 함수로 그린다
+    if (reversedZ) {
+        glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        glClearDepth(0.0);
+        glDepthFunc(GL_GREATER);
     }
+    RenderVirtualTextureFeedback();
+
+    if (reversedZ)
+        m_sceneFramebuffer->Bind();
+    else
+        Framebuffer::BindToDefault();
+    glViewport(0, 0, m_width, m_height);
+    // sRGB texture는 linear로 읽히므로 출력할 때 다시 sRGB로 encode 한다
+    glEnable(GL_FRAMEBUFFER_SRGB);
+ 	
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
 
-    	
-    auto skyboxModelTransform =
-        glm::translate(glm::mat4(1.0), m_cameraPos) *
-        glm::scale(glm::mat4(1.0), glm::vec3(50.0f));
+    // skybox는 카메라를 감싸는 상자, depth를 쓰지 않아야 상자보다 먼 천체가 가려지지 않는다
+    auto skyboxModelTransform = glm::scale(glm::mat4(1.0), glm::vec3(50.0f));
     m_skyboxProgram->Use();
     m_cubeTexture->Bind();
-    m_skyboxProgram->SetUniform("skybox", 0);
-    m_skyboxProgram->SetUniform("transform", projection * view * skyboxModelTransform);
-    m_box->Draw(m_skyboxProgram.get());
-
-    glm::vec3 lightPos = m_light.position;
-    glm::vec3 lightDir = m_light.direction;
+    m_skyboxProgram->SetUniform(m_skyboxUniforms.skybox, 0);
+    m_skyboxProgram->SetUniform(m_skyboxUniforms.modelTransform, skyboxModelTransform);
+    glDepthMask(GL_FALSE);
+    m_box->Draw(m_skyboxProgram.get(), m_skyboxUniforms.mesh);
+    glDepthMask(GL_TRUE);
 
     auto lightModelTransform =
-        glm::translate(glm::mat4(1.0), m_light.position) *
+        glm::translate(glm::mat4(1.0), lightPosition) *
         glm::scale(glm::mat4(1.0), glm::vec3(0.1f)); 	
-    m_simpleProgram->Use();
-    m_simpleProgram->SetUniform("color", glm::vec4(m_light.ambient + m_light.diffuse, 1.0f));
-    m_simpleProgram->SetUniform("transform", projection * view * lightModelTransform);
-    m_sphere->Draw(m_simpleProgram.get());
+    auto cameraFrustum = Frustum::FromMatrix(projection * view);
+    if (!m_frustumCulling ||
+        cameraFrustum.IntersectsSphere(lightPosition, m_sphere->GetBoundingRadius() * 0.1f)) {
+        m_simpleProgram->Use();
+        m_simpleProgram->SetUniform(m_simpleUniforms.color,
+            glm::vec4(m_light.ambient + m_light.diffuse, 1.0f));
+        m_simpleProgram->SetUniform(m_simpleUniforms.modelTransform, lightModelTransform);
+        m_sphere->Draw(m_simpleProgram.get(), m_simpleUniforms.mesh);
+    }
     
     m_lightingShadowProgram->Use();
-    m_lightingShadowProgram->SetUniform("viewPos", m_cameraPos);   	
-    m_lightingShadowProgram->SetUniform("light.position", m_light.position);
-    m_lightingShadowProgram->SetUniform("light.direction", m_light.direction);
-    m_lightingShadowProgram->SetUniform("light.attenuation", GetAttenuationCoeff(m_light.distance));
-    m_lightingShadowProgram->SetUniform("light.ambient", m_light.ambient);
-    m_lightingShadowProgram->SetUniform("light.diffuse", m_light.diffuse);
-    m_lightingShadowProgram->SetUniform("light.specular", m_light.specular);
-    m_lightingShadowProgram->SetUniform("lightTransform", lightView);
     glActiveTexture(GL_TEXTURE3);
     m_shadowMap->GetShadowMap()->Bind();
-    m_lightingShadowProgram->SetUniform("shadowMap", 3);
+    m_lightingShadowProgram->SetUniform(m_lightingUniforms.shadowMap, 3);
+    glActiveTexture(GL_TEXTURE4);
+    m_shadowCubeMap->GetShadowCubeMap()->Bind();
+    m_lightingShadowProgram->SetUniform(m_lightingUniforms.shadowCubeMap, 4);
     glActiveTexture(GL_TEXTURE0);
     
-    DrawScene(view, projection, m_lightingShadowProgram.get());
+    DrawScene(view, projection, m_lightingShadowProgram.get(), m_lightingUniforms);
+
+    if (reversedZ) {
+        glClipControl(GL_LOWER_LEFT, GL_NEGATIVE_ONE_TO_ONE);
+        glClearDepth(1.0);
+        glDepthFunc(GL_LESS);
+
+        // multisample resolve 후 화면 전체 사각형으로 옮긴다, sRGB encode는 여기서 된다
+        m_sceneFramebuffer->ResolveTo(m_framebuffer.get());
+        Framebuffer::BindToDefault();
+        glDisable(GL_DEPTH_TEST);
+        m_postProgram->Use();
+        m_postProgram->SetUniform(m_postUniforms.transform,
+            glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 2.0f, 1.0f)));
+        m_framebuffer->GetColorAttachment()->Bind();
+        m_postProgram->SetUniform(m_postUniforms.tex, 0);
+        m_postProgram->SetUniform(m_postUniforms.gamma, m_gamma);
+        m_plane->Draw(m_postProgram.get(), m_postUniforms.mesh);
+        glEnable(GL_DEPTH_TEST);
+    }
+    // ImGui는 sRGB 변환 없이 그린다
+    glDisable(GL_FRAMEBUFFER_SRGB);
 }
 
 void Context::DrawScene(const glm::mat4& view,
     const glm::mat4& projection,
-    const Program* program) {
-    //자전  1S = 24H
-    glm::mat4 sun_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 14.4f), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 mercury_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 6.1f), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 venus_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * -1.48f), glm::vec3(0.0f, 1.0f, 1.0f));
-    glm::mat4 earth_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 360.0f), glm::vec3(0.0f, 1.0f, 0.2f));
-    glm::mat4 moon_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 13.3f), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 mars_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 360.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    if(!m_rotating){
-        sun_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        mercury_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        venus_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 0.0f), glm::vec3(0.0f, 1.0f, 1.0f));
-        earth_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 0.0f), glm::vec3(0.0f, 1.0f, 0.2f));
-        moon_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        mars_roatation = glm::rotate(glm::mat4(1.0f), glm::radians((float)glfwGetTime() * 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    }
-    //공전 
-    const float pi = 3.141592f;
-    float mercury_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 88.0f);
-    float mercury_x = cos(mercury_Rangle) * 5.0f;
-    float mercury_z = sin(mercury_Rangle) * 5.0f;
-    float venus_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 225.0f);
-    float venus_x = cos(venus_Rangle) * 7.0f;
-    float venus_z = sin(venus_Rangle) * 7.0f;
-    float earth_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 365.0f); 
-    float earth_x = cos(earth_Rangle) * 9.0f;
-    float earth_z = sin(earth_Rangle) * 9.0f;
-    float mars_Rngle = (360.f / 180.0f * (float)glfwGetTime() * pi / 687.0f);
-    float mars_x = cos(mars_Rngle) * 12.0f;
-    float mars_z = sin(mars_Rngle) * 12.0f;
-    float moon_Rangle = (360.f / 180.0f * (float)glfwGetTime() * pi / 27.0f);
-    float moon_x = earth_x + cos(moon_Rangle) * 1.0f;
-    float moon_z = earth_z + sin(moon_Rangle) * 1.0f;
-    if(!m_revolution){
-        mercury_x = 5.0f;
-        mercury_z = 0.0f;
-        venus_x = 7.0f;
-        venus_z = 0.0f;
-        earth_x = 9.0f;
-        earth_z = 0.0f;
-        mars_x = 12.0f;
-        mars_z = 0.0f;
-        moon_x = 10.0f;
-        moon_z = 0.0f;
-    }
-    glm::mat4 mercury_revoultion = glm::translate(glm::mat4(1.0f), glm::vec3(mercury_x, 5.0f, mercury_z));
-    glm::mat4 venus_revoultion = glm::translate(glm::mat4(1.0f), glm::vec3(venus_x, 5.0f, venus_z));
-    glm::mat4 earth_revoultion = glm::translate(glm::mat4(1.0f), glm::vec3(earth_x, 5.0f, earth_z));
-    glm::mat4 mars_revoultion = glm::translate(glm::mat4(1.0f), glm::vec3(mars_x, 5.0f, mars_z));
-    glm::mat4 moon_revoultion = glm::translate(glm::mat4(1.0f), glm::vec3(moon_x, 5.0f, moon_z));
-    
+    const Program* program,
+    const ProgramUniforms& uniforms,
+    bool shadowPass,
+    int shadowFace) {
     program->Use();
-    //태양
-    const int sphereCount = 7;
-    const float offset = 1.2f;
-    auto modelTransform =
-        glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 5.0f, 0.0f))*
-        sun_roatation *
-        glm::scale(glm::mat4(1.0f), glm::vec3(5.0f, 5.0f, 5.0f));
-        auto transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_sunMaterial->SetToProgram(program);
-        m_sphere->Draw(program);
-    //수성
-    modelTransform =
-        mercury_revoultion*
-        mercury_roatation *
-        glm::scale(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.5f));
-        transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_mercuryMaterial->SetToProgram(program);
-        m_sphere->Draw(program);
-    //화성
-    modelTransform =
-        venus_revoultion*
-        venus_roatation *
-        glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 1.0f, 1.0f));
-        transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_venusMaterial->SetToProgram(program);
-        m_sphere->Draw(program);
-    //지구
-    modelTransform =
-        earth_revoultion*
-        earth_roatation *
-        glm::scale(glm::mat4(1.0f), glm::vec3(1.2f, 1.2f, 1.2f));
-        transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_earthMaterial->SetToProgram(program);
-        m_sphere->Draw(program);
-    //달
-    modelTransform =
-        moon_revoultion*
-        moon_roatation *
-        glm::scale(glm::mat4(1.0f), glm::vec3(0.2f, 0.2f, 0.2f));
-        transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_moonMaterial->SetToProgram(program);
-        m_sphere->Draw(program);
-    //화성
-    modelTransform =
-        mars_revoultion*
-        mars_roatation *
-        glm::scale(glm::mat4(1.0f), glm::vec3(0.8f, 0.8f, 0.8f));
-        transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_marsMaterial->SetToProgram(program);
-        m_sphere->Draw(program);
+    program->SetUniform(uniforms.transform, projection * view);
+    if (shadowPass) {
+        // shadow pass는 face별로 culling된 caster만 그린다
+        for (auto& batch: m_shadowBatches[shadowFace]) {
+            batch.mesh->DrawInstanced(program, uniforms.mesh, m_shadowInstanceBuffer.get(),
+                batch.first, batch.count);
+        }
+        return;
+    }
+    bool virtualTexturing = m_virtualTexturing && m_vtLightingProgram;
+    for (auto& batch: m_visibleBatches) {
+        if (virtualTexturing && FindVirtualTexture(batch.material.get()) >= 0)
+            continue;
+        batch.material->SetToProgram(program, uniforms.mesh.material);
+        batch.mesh->DrawInstanced(program, uniforms.mesh, m_instanceBuffer.get(),
+            batch.first, batch.count);
+    }
+    if (!virtualTexturing)
+        return;
+
+    // virtual texture 천체는 page table을 읽는 program으로 따로 그린다
+    m_vtLightingProgram->Use();
+    m_vtLightingProgram->SetUniform(m_vtLightingUniforms.transform, projection * view);
+    for (auto& batch: m_visibleBatches) {
+        int id = FindVirtualTexture(batch.material.get());
+        if (id < 0)
+            continue;
+        batch.material->SetToProgram(m_vtLightingProgram.get(), m_vtLightingUniforms.mesh.material);
+        m_virtualTextures[id].texture->SetToProgram(m_vtLightingProgram.get(),
+            m_vtLightingUniforms.virtualTexture, 5, 6);
+        batch.mesh->DrawInstanced(m_vtLightingProgram.get(), m_vtLightingUniforms.mesh,
+            m_instanceBuffer.get(),
+            batch.first, batch.count);
+    }
+}
+
+void Context::CullShadowCasters(const glm::mat4& lightTransform,
+    std::vector<InstanceBatch>& batches) {
+    batches.clear();
+    auto frustum = Frustum::FromMatrix(lightTransform);
+    for (auto& batch: m_instanceBatches) {
+        if (!batch.castsShadow)
+            continue;
+        InstanceBatch culled = batch;
+        culled.first = m_shadowInstanceData.size();
+        culled.count = 0;
+        frustum.IntersectSpheres(m_boundsX.data() + batch.first, m_boundsY.data() + batch.first,
+            m_boundsZ.data() + batch.first, m_boundsRadius.data() + batch.first,
+            batch.count, m_boundsVisible.data() + batch.first);
+        for (size_t i = batch.first; i < batch.first + batch.count; i++) {
+            if (!m_boundsVisible[i])
+                continue;
+            m_shadowInstanceData.push_back(m_instanceData[i]);
+            culled.count++;
+        }
+        if (culled.count > 0)
+            batches.push_back(culled);
+    }
+}
+
+void Context::RenderShadowMap(const glm::mat4& lightTransform, const glm::vec3& lightPosition) {
+    // 앞면을 제거하고 polygon offset을 주어 shadow acne를 줄인다
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    m_shadowInstanceData.clear();
+    if (m_omniShadow) {
+        // 태양은 point light이므로 6방향 cube map에 그린다
+        static const glm::vec3 faceDirections[6][2] = {
+            { glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+            { glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+            { glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f) },
+            { glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f) },
+            { glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+            { glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+        };
+        auto faceProjection = glm::perspective(glm::radians(90.0f), 1.0f,
+            m_light.shadowNearPlane, m_light.shadowFarPlane);
+        glm::mat4 faceViews[6];
+        for (int face = 0; face < 6; face++) {
+            faceViews[face] = glm::lookAt(lightPosition,
+                lightPosition + faceDirections[face][0],
+                faceDirections[face][1]);
+            CullShadowCasters(faceProjection * faceViews[face], m_shadowBatches[face]);
+        }
+        m_shadowInstanceBuffer->Update(m_shadowInstanceData.data(), m_shadowInstanceData.size());
+
+        glViewport(0, 0, m_shadowCubeMap->GetWidth(), m_shadowCubeMap->GetHeight());
+        for (int face = 0; face < 6; face++) {
+            m_shadowCubeMap->BindFace(face);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            DrawScene(faceViews[face], faceProjection, m_shadowProgram.get(), m_shadowUniforms,
+                true, face);
+        }
+    }
+    else {
+        CullShadowCasters(lightTransform, m_shadowBatches[0]);
+        m_shadowInstanceBuffer->Update(m_shadowInstanceData.data(), m_shadowInstanceData.size());
+
+        m_shadowMap->Bind();
+        glViewport(0, 0, m_shadowMap->GetWidth(), m_shadowMap->GetHeight());
+        glClear(GL_DEPTH_BUFFER_BIT);
+        DrawScene(lightTransform, glm::mat4(1.0f), m_shadowProgram.get(), m_shadowUniforms,
+            true, 0);
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glCullFace(GL_BACK);
+    glDisable(GL_CULL_FACE);
+}
+
+void Context::SetShadowQuality(int quality) {
+    m_shadowQuality = glm::clamp(quality, 0, (int)IM_ARRAYSIZE(s_shadowMapSizes) - 1);
+    int size = s_shadowMapSizes[m_shadowQuality];
+    m_shadowMap->SetResolution(size, size);
+    m_shadowCubeMap->SetResolution(size, size);
+    SPDLOG_INFO("shadow map resolution: {}, memory: {:.1f} MB", size,
+        (m_shadowMap->GetMemorySize() + m_shadowCubeMap->GetMemorySize()) / (1024.0 * 1024.0));
+}
+
+void Context::SetAsteroidCount(int count) {
+    // 화성 궤도 바깥의 소행성대, 개수를 바꿔도 같은 배치가 유지되도록 seed 고정
+    m_bodies->Truncate(m_planetCount);
+    int sun = m_bodies->FindBody("sun");
+    std::mt19937 generator(2021);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < count; i++) {
+        CelestialBody body;
+        body.name = "asteroid";
+        body.scale = glm::mix(0.03f, 0.12f, unit(generator));
+        body.orbitRadius = glm::mix(14.0f, 17.0f, unit(generator));
+        // 케플러 제3법칙, 지구(반경 9.0, 365일) 기준
+        body.orbitPeriod = 365.0f * powf(body.orbitRadius / 9.0f, 1.5f);
+        body.orbitPhase = unit(generator) * glm::two_pi<float>();
+        // 소행성대처럼 약간 찌그러지고 기울어진 궤도
+        body.eccentricity = unit(generator) * 0.2f;
+        body.inclination = glm::radians(unit(generator) * 10.0f);
+        body.ascendingNode = unit(generator) * glm::two_pi<float>();
+        body.argumentOfPeriapsis = unit(generator) * glm::two_pi<float>();
+        body.spinRate = glm::mix(-90.0f, 90.0f, unit(generator));
+        body.spinAxis = glm::vec3(unit(generator) - 0.5f, 1.0f, unit(generator) - 0.5f);
+        body.parent = sun;
+        body.mesh = m_asteroid;
+        body.material = m_asteroidMaterial;
+        m_bodies->AddBody(body);
+    }
+    BuildInstanceBatches();
+    if (m_physics)
+        ResetPhysics();
+}
+
+void Context::ResetPhysics() {
+    // G * M, 태양은 지구 궤도(반경 9.0, 365일)가 그대로 유지되는 값
+    const float sunMass = glm::two_pi<float>() * glm::two_pi<float>() * 729.0f / (365.0f * 365.0f);
+    const size_t count = m_bodies->GetCount();
+    const double time = m_clock->GetTime();
+
+    // 진행 방향은 조금 뒤 궤도 위치와의 차이로 구한다
+    std::vector<glm::dvec3> ahead(count);
+    m_bodies->Update(time + 0.01, true, false);
+    for (size_t i = 0; i < count; i++)
+        ahead[i] = m_bodies->GetPosition(i);
+    m_bodies->Update(time, true, false);
+
+    // 속력은 부모 기준 활력 방정식(vis-viva), 긴반지름은 orbitRadius
+    std::vector<glm::vec3> velocity(count, glm::vec3(0.0f));
+    glm::vec3 momentum(0.0f);
+    float totalMass = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float mass = m_bodies->GetMass(i) * sunMass;
+        int parent = m_bodies->GetParent(i);
+        if (parent >= 0) {
+            glm::vec3 offset = glm::vec3(m_bodies->GetPosition(i) - m_bodies->GetPosition(parent));
+            glm::vec3 motion = glm::vec3((ahead[i] - ahead[parent]) - glm::dvec3(offset));
+            float distance = glm::length(offset);
+            float mu = m_bodies->GetMass(parent) * sunMass + mass;
+            float speed = sqrtf(glm::max(mu * (2.0f / distance -
+                1.0f / m_bodies->GetOrbitRadius(i)), 0.0f));
+            velocity[i] = velocity[parent];
+            if (distance > 0.0f && glm::length(motion) > 0.0f)
+                velocity[i] = velocity[i] + glm::normalize(motion) * speed;
+        }
+        momentum = momentum + velocity[i] * mass;
+        totalMass += mass;
+    }
+
+    // 전체 운동량을 0으로 맞춰 태양계 전체가 흘러가지 않게 한다
+    glm::vec3 drift = totalMass > 0.0f ? momentum / totalMass : glm::vec3(0.0f);
+    m_nbody->Clear();
+    for (size_t i = 0; i < count; i++)
+        m_nbody->AddBody(m_bodies->GetPosition(i), velocity[i] - drift,
+            m_bodies->GetMass(i) * sunMass);
+    m_physicsPositions.resize(count);
+}
+
+void Context::StepPhysics(int steps) {
+    // fixed step 하나를 1일 이하로 나누되, 느린 프레임이 밀리지 않도록 한 프레임에 32번까지만
+    const double maxStepDays = 1.0;
+    const int maxSubsteps = 32;
+    double days = m_clock->GetStepDays() * steps;
+    if (days <= 0.0)
+        return;
+    int substeps = std::min((int)ceil(days / maxStepDays), maxSubsteps);
+    for (int i = 0; i < substeps; i++)
+        m_nbody->Step(days / substeps);
+}
+
+void Context::BuildInstanceBatches() {
+    // mesh, material이 같은 천체끼리 instance buffer에서 연속되도록 정렬
+    m_instanceOrder.resize(m_bodies->GetCount());
+    for (uint32_t i = 0; i < (uint32_t)m_instanceOrder.size(); i++)
+        m_instanceOrder[i] = i;
+    std::stable_sort(m_instanceOrder.begin(), m_instanceOrder.end(),
+        [&](uint32_t a, uint32_t b) {
+            auto meshA = m_bodies->GetMesh(a).get();
+            auto meshB = m_bodies->GetMesh(b).get();
+            if (meshA != meshB)
+                return meshA < meshB;
+            auto materialA = m_bodies->GetMaterial(a).get();
+            auto materialB = m_bodies->GetMaterial(b).get();
+            if (materialA != materialB)
+                return materialA < materialB;
+            return m_bodies->GetCastsShadow(a) && !m_bodies->GetCastsShadow(b);
+        });
+
+    m_instanceBatches.clear();
+    for (size_t i = 0; i < m_instanceOrder.size(); i++) {
+        auto body = m_instanceOrder[i];
+        auto mesh = m_bodies->GetMesh(body);
+        auto material = m_bodies->GetMaterial(body);
+        bool castsShadow = m_bodies->GetCastsShadow(body);
+        if (m_instanceBatches.empty() ||
+            m_instanceBatches.back().mesh != mesh ||
+            m_instanceBatches.back().material != material ||
+            m_instanceBatches.back().castsShadow != castsShadow) {
+            m_instanceBatches.push_back({ mesh, material, castsShadow, i, 0 });
+        }
+        m_instanceBatches.back().count++;
+    }
+    m_instanceData.resize(m_instanceOrder.size());
+    m_boundsX.resize(m_instanceOrder.size());
+    m_boundsY.resize(m_instanceOrder.size());
+    m_boundsZ.resize(m_instanceOrder.size());
+    m_boundsRadius.resize(m_instanceOrder.size());
+    m_boundsVisible.resize(m_instanceOrder.size());
+}
+
+// 천체마다 화면에서의 반지름(pixel)으로 구의 LOD level을 고른다
+// level이 바뀐 천체가 있을 때만 instance batch를 다시 만든다
+void Context::UpdateLod() {
+    float pixelsPerUnit = m_height * 0.5f / tanf(glm::radians(m_cameraFov) * 0.5f);
+    bool changed = false;
+    for (size_t i = 0; i < m_bodies->GetCount(); i++) {
+        int current = m_sphereLod->FindLevel(m_bodies->GetMesh(i).get());
+        if (current < 0)
+            continue;
+        float radius = m_bodies->GetScale(i) * 0.5f;
+        float distance = (float)glm::length(m_bodies->GetPosition(i) - m_cameraPos);
+        // 카메라가 구 안이나 표면에 붙어 있으면 가장 세밀한 level
+        float radiusInPixels = distance > radius ?
+            radius / distance * pixelsPerUnit : FLT_MAX;
+        int level = m_sphereLod->SelectLevel(radiusInPixels, m_lodPixelError, current);
+        if (level != current) {
+            m_bodies->SetMesh(i, m_sphereLod->GetMesh(level));
+            changed = true;
+        }
+    }
+    if (changed)
+        BuildInstanceBatches();
 }
- 
\ No newline at end of file
+
+// instance transform과 bounding sphere를 모은다, GPU에는 CullInstances에서 보이는 것만 올린다
+void Context::UpdateInstances() {
+    auto& transforms = m_bodies->GetRelativeTransforms();
+    for (auto& batch: m_instanceBatches) {
+        const glm::vec4 center = glm::vec4(batch.mesh->GetBoundingCenter(), 1.0f);
+        const float radius = batch.mesh->GetBoundingRadius();
+        for (size_t i = batch.first; i < batch.first + batch.count; i++) {
+            auto body = m_instanceOrder[i];
+            m_instanceData[i] = transforms[body];
+            glm::vec3 boundsCenter = glm::vec3(m_instanceData[i] * center);
+            m_boundsX[i] = boundsCenter.x;
+            m_boundsY[i] = boundsCenter.y;
+            m_boundsZ[i] = boundsCenter.z;
+            // 천체 scale은 세 축이 같다
+            m_boundsRadius[i] = radius * m_bodies->GetScale(body);
+        }
+    }
+}
+
+// 카메라 frustum 밖의 instance를 batch 안에서 빼고 앞으로 당겨서 올린다
+void Context::CullInstances(const glm::mat4& viewProjection) {
+    double begin = glfwGetTime();
+    const size_t count = m_instanceData.size();
+    if (m_frustumCulling) {
+        auto frustum = Frustum::FromMatrix(viewProjection);
+        m_cullStats.visible = (int)frustum.IntersectSpheres(m_boundsX.data(), m_boundsY.data(),
+            m_boundsZ.data(), m_boundsRadius.data(), count, m_boundsVisible.data());
+    }
+    else {
+        std::fill(m_boundsVisible.begin(), m_boundsVisible.end(), 1);
+        m_cullStats.visible = (int)count;
+    }
+    m_cullStats.tested = (int)count;
+
+    m_visibleBatches.clear();
+    m_visibleInstanceData.clear();
+    for (auto& batch: m_instanceBatches) {
+        InstanceBatch visible = batch;
+        visible.first = m_visibleInstanceData.size();
+        visible.count = 0;
+        for (size_t i = batch.first; i < batch.first + batch.count; i++) {
+            if (!m_boundsVisible[i])
+                continue;
+            m_visibleInstanceData.push_back(m_instanceData[i]);
+            visible.count++;
+        }
+        if (visible.count > 0)
+            m_visibleBatches.push_back(visible);
+    }
+    m_instanceBuffer->Update(m_visibleInstanceData.data(), m_visibleInstanceData.size());
+    m_cullStats.cullMs = (float)((glfwGetTime() - begin) * 1000.0);
+}
+
+void Context::FocusCamera(int bodyIndex) {
+    if (bodyIndex < 0)
+        return;
+    auto position = m_bodies->GetPosition(bodyIndex);
+    float scale = m_bodies->GetScale(bodyIndex);
+    int parent = m_bodies->GetParent(bodyIndex);
+    if (parent < 0) {
+        // 태양은 위에서 내려다본다
+        m_cameraPos = position + glm::dvec3(0.0, scale * 2.0, 0.0);
+        m_cameraPitch = -89.0f;
+    }
+    else if (m_bodies->GetParent(parent) >= 0) {
+        // 위성은 모행성 반대편에서 바라본다
+        m_cameraPos = position - glm::dvec3(scale, 0.0, scale);
+        m_cameraYaw = 225.0f;
+        m_cameraPitch = 0.0f;
+    }
+    else {
+        m_cameraPos = position + glm::dvec3(scale, 0.0, scale);
+        m_cameraYaw = 45.0f;
+        m_cameraPitch = 0.0f;
+    }
+}
\ No newline at end of file
@@ -8,9 +8,19 @@
 #include "vertex_layout.h"
 #include "texture.h"
 #include "mesh.h"
+#include "mesh_lod.h"
 #include "model.h"
 #include "framebuffer.h"
 #include "shadow_map.h"
+#include "celestial_body.h"
+#include "simulation_clock.h"
+#include "nbody_simulation.h"
+#include "uniform_block.h"
+#include "frustum.h"
+#include "thread_pool.h"
+#include "texture_uploader.h"
+#include "texture_cache.h"
+#include "virtual_texture.h"
 
 CLASS_PTR(Context)
 class Context {
@@ -22,13 +32,50 @@ public:
     void MouseMove(double x, double y);
     void MouseButton(int button, int action, double x, double y);
 
+    // program마다 link 직후 한 번 찾아두는 uniform id, 프레임마다 이름으로 찾지 않는다
+    // program에 없는 uniform은 invalid id로 남고 SetUniform이 무시한다
+    struct ProgramUniforms {
+        UniformId transform;
+        UniformId modelTransform;
+        UniformId color;
+        UniformId skybox;
+        UniformId tex;
+        UniformId gamma;
+        UniformId shadowMap;
+        UniformId shadowCubeMap;
+        UniformId vtId;
+        UniformId vtFeedbackBias;
+        MeshUniforms mesh;
+        VirtualTextureUniforms virtualTexture;
+        static ProgramUniforms Find(const Program* program);
+    };
+
     void DrawScene(const glm::mat4& view,
         const glm::mat4& projection,
-        const Program* program);
+        const Program* program,
+        const ProgramUniforms& uniforms,
+        bool shadowPass = false,
+        int shadowFace = 0);
 
 private:
     Context() {}
     bool Init();
+    ThreadPoolUPtr m_threadPool;
+
+    // 파일 하나는 한 번만 decode / upload 한다
+    TextureCacheUPtr m_textureCache;
+
+    // decode 중인 texture, 끝나면 uploader로 넘어간 뒤 material들의 diffuse를 바꾼다
+    struct PendingTexture {
+        std::string filename;
+        std::future<ImageUPtr> image;
+        std::vector<MaterialPtr> materials;
+    };
+    std::vector<PendingTexture> m_pendingTextures;
+    TextureUploaderUPtr m_textureUploader;
+    int m_textureUploadBudget { 8 };    // MB / frame
+    void LoadBodyTexture(int bodyIndex, const std::string& filename);
+    void UpdateTextureStreaming();
     ProgramUPtr m_program;
     ProgramUPtr m_simpleProgram;
     ProgramUPtr m_textureProgram;
@@ -37,11 +84,26 @@ private:
 
     MeshUPtr m_box;	
     MeshUPtr m_plane;
-    MeshUPtr m_sphere;
+    MeshPtr m_sphere;
+    MeshPtr m_asteroid;
+    // 천체 구는 화면 크기에 따라 8x16 ~ 256x512 중에서 고른다
+    MeshLodUPtr m_sphereLod;
+    float m_lodPixelError { 0.5f };
+    void UpdateLod();
   
     // animation
     bool m_revolution { true };
     bool m_rotating { true };
+    // 공전 / 자전은 wall clock이 아닌 시뮬레이션 시간으로 진행한다
+    SimulationClockUPtr m_clock;
+    int m_timeScaleIndex { 1 };
+    int m_simulationSteps { 0 };    // 이번 프레임에 진행한 fixed step 수
+    // n-body 물리 모드, 켜는 순간의 궤도 위치 / 속도에서 시작해 중력으로만 움직인다
+    NBodySimulationUPtr m_nbody;
+    bool m_physics { false };
+    std::vector<glm::dvec3> m_physicsPositions;
+    void ResetPhysics();
+    void StepPhysics(int steps);
     glm::vec3 m_rotspeed { glm::vec3(0.0f, 0.0f, 0.0f) };
     glm::vec3 m_rotation { glm::vec3(0.0f, 10.0f, 0.0f) };
 
@@ -53,6 +115,8 @@ private:
         glm::vec3 position { glm::vec3(0.0f, 5.0f, 0.0f) };
         glm::vec3 direction { glm::vec3(-0.5f, -1.5f, -1.0f) };
         float distance { 150.0f };
+        float shadowNearPlane { 2.0f };
+        float shadowFarPlane { 50.0f };
         glm::vec3 ambient { glm::vec3(1.0f, 1.0f, 1.0f) };
         glm::vec3 diffuse { glm::vec3(1.0f, 1.0f, 1.0f) };
         glm::vec3 specular { glm::vec3(1.0f, 1.0f, 1.0f) };
@@ -64,26 +128,86 @@ private:
     MaterialPtr m_planeMaterial;
     MaterialPtr m_box1Material;
     MaterialPtr m_box2Material;
-    MaterialPtr m_sunMaterial;
-    MaterialPtr m_mercuryMaterial;
-    MaterialPtr m_venusMaterial;
-    MaterialPtr m_earthMaterial;
-    MaterialPtr m_moonMaterial;
-    MaterialPtr m_marsMaterial;
     // 
     TexturePtr m_windowTexture;
 
+    // 태양계 천체
+    CelestialBodyTableUPtr m_bodies;
+    size_t m_planetCount { 0 };
+    int m_asteroidCount { 2000 };
+    MaterialPtr m_asteroidMaterial;
+    void SetAsteroidCount(int count);
+    void FocusCamera(int bodyIndex);
+
+    // instancing, 같은 mesh/material 천체를 한 번의 draw call로 그린다
+    struct InstanceBatch {
+        MeshPtr mesh;
+        MaterialPtr material;
+        bool castsShadow { true };
+        size_t first { 0 };
+        size_t count { 0 };
+    };
+    std::vector<InstanceBatch> m_instanceBatches;
+    std::vector<uint32_t> m_instanceOrder;
+    std::vector<glm::mat4> m_instanceData;
+    BufferUPtr m_instanceBuffer;
+    void BuildInstanceBatches();
+    void UpdateInstances();
+
+    // instance 순서의 카메라 기준 bounding sphere (structure-of-arrays), 4개씩 SIMD로 검사한다
+    std::vector<float> m_boundsX, m_boundsY, m_boundsZ, m_boundsRadius;
+    std::vector<uint8_t> m_boundsVisible;
+    // 카메라 frustum 안에 있는 instance만 m_instanceBuffer에 올리고 그린다
+    std::vector<InstanceBatch> m_visibleBatches;
+    std::vector<glm::mat4> m_visibleInstanceData;
+    bool m_frustumCulling { true };
+    struct CullStats {
+        int tested { 0 };
+        int visible { 0 };
+        float cullMs { 0.0f };
+    };
+    CullStats m_cullStats;
+    void CullInstances(const glm::mat4& viewProjection);
+
+    // shadow pass용 instance, cube map face마다 frustum culling 된다
+    std::vector<InstanceBatch> m_shadowBatches[6];
+    std::vector<glm::mat4> m_shadowInstanceData;
+    BufferUPtr m_shadowInstanceBuffer;
+    void CullShadowCasters(const glm::mat4& lightTransform,
+        std::vector<InstanceBatch>& batches);
+
     // camera parameter
     bool m_cameraControl { false };
     glm::vec2 m_prevMousePos { glm::vec2(0.0f) };
     float m_cameraPitch { 0.0f };                             //피치각
     float m_cameraYaw { 45.0f };                                 //요각
-    glm::vec3 m_cameraPos { glm::vec3(15.0f, 6.0f, 7.0f) };      //카메라 위치
+    glm::dvec3 m_cameraPos { glm::dvec3(15.0, 6.0, 7.0) };      //카메라 위치, 그리는 값은 모두 이 위치 기준
     glm::vec3 m_cameraFront { glm::vec3(0.0f, 0.0f, -1.0f) };   //카메라 바라보는 방향 
     glm::vec3 m_cameraUp { glm::vec3(0.0f, 1.0f, 0.0f) };       //카메라 화면의 세로 축 방향
+    float m_cameraFov { 45.0f };     // 세로 시야각(degree), projection과 LOD 선택이 같이 쓴다
 
     // framebuffer
     FramebufferUPtr m_framebuffer;
+    // reversed-Z: clip control로 depth를 [0, 1]에 두고 가까울수록 1, 먼 평면은 무한대
+    // 기본 framebuffer의 24 bit 정수 depth로는 이득이 없으므로 32 bit float depth에 그린 뒤 옮긴다
+    bool m_reversedZ { false };
+    FramebufferUPtr m_sceneFramebuffer;
+    float m_cameraNearPlane { 0.01f };
+
+    // virtual texture, page file이 있는 천체만 사용
+    struct VirtualTextureEntry {
+        std::string name;
+        MaterialPtr material;
+        VirtualTextureUPtr texture;
+    };
+    std::vector<VirtualTextureEntry> m_virtualTextures;
+    VirtualTextureFeedbackUPtr m_vtFeedback;
+    ProgramUPtr m_vtLightingProgram;
+    ProgramUPtr m_vtFeedbackProgram;
+    bool m_virtualTexturing { true };
+    int m_vtUploadsPerFrame { 16 };
+    int FindVirtualTexture(const Material* material) const;
+    void RenderVirtualTextureFeedback();
 
     // cubemap
     CubeTextureUPtr m_cubeTexture;
@@ -92,7 +216,27 @@ private:
     
     // shadow map
     ShadowMapUPtr m_shadowMap;
+    ShadowMapUPtr m_shadowCubeMap;
+    ProgramUPtr m_shadowProgram;
     ProgramUPtr m_lightingShadowProgram;
+    bool m_omniShadow { true };
+    int m_shadowQuality { 1 };
+    int m_shadowPcfKernel { 1 };
+    bool CreateLightingProgram();
+    void SetShadowQuality(int quality);
+    void RenderShadowMap(const glm::mat4& lightTransform, const glm::vec3& lightPosition);
+    ProgramUniforms m_lightingUniforms;
+    ProgramUniforms m_vtLightingUniforms;
+    ProgramUniforms m_vtFeedbackUniforms;
+    ProgramUniforms m_shadowUniforms;
+    ProgramUniforms m_simpleUniforms;
+    ProgramUniforms m_skyboxUniforms;
+    ProgramUniforms m_postUniforms;
+    Program::UniformStats m_uniformStats;
+
+    // 프레임마다 한 번 올리는 카메라/조명 uniform buffer
+    BufferUPtr m_perFrameBuffer;
+    BufferUPtr m_lightsBuffer;
 
     int m_width {WINDOW_WIDTH};
     int m_height {WINDOW_HEIGHT};
@@ -1,8 +1,16 @@
 #include "framebuffer.h"
 
-FramebufferUPtr Framebuffer::Create(const TexturePtr colorAttachment) {
+FramebufferUPtr Framebuffer::Create(const TexturePtr colorAttachment, uint32_t depthFormat) {
     auto framebuffer = FramebufferUPtr(new Framebuffer());
-    if (!framebuffer->InitWithColorAttachment(colorAttachment))
+    if (!framebuffer->InitWithColorAttachment(colorAttachment, depthFormat))
+        return nullptr;
+    return std::move(framebuffer);
+}
+
+FramebufferUPtr Framebuffer::CreateMultisample(int width, int height, int samples,
+    uint32_t colorFormat, uint32_t depthFormat) {
+    auto framebuffer = FramebufferUPtr(new Framebuffer());
+    if (!framebuffer->InitMultisample(width, height, samples, colorFormat, depthFormat))
         return nullptr;
     return std::move(framebuffer);
 }
@@ -11,6 +19,9 @@ Framebuffer::~Framebuffer() {
     if (m_depthStencilBuffer) {
         glDeleteRenderbuffers(1, &m_depthStencilBuffer);
     }
+    if (m_colorBuffer) {
+        glDeleteRenderbuffers(1, &m_colorBuffer);
+    }
     if (m_framebuffer) {
         glDeleteFramebuffers(1, &m_framebuffer);
     }
@@ -24,8 +35,19 @@ void Framebuffer::Bind() const {
     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
 }
 
-bool Framebuffer::InitWithColorAttachment(const TexturePtr colorAttachment) {
+void Framebuffer::ResolveTo(const Framebuffer* target) const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target->Get());
+    glBlitFramebuffer(0, 0, m_width, m_height,
+        0, 0, target->GetWidth(), target->GetHeight(),
+        GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    BindToDefault();
+}
+
+bool Framebuffer::InitWithColorAttachment(const TexturePtr colorAttachment, uint32_t depthFormat) {
     m_colorAttachment = colorAttachment;
+    m_width = colorAttachment->GetWidth();
+    m_height = colorAttachment->GetHeight();
     glGenFramebuffers(1, &m_framebuffer);
     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
 
@@ -36,7 +58,7 @@ bool Framebuffer::InitWithColorAttachment(const TexturePtr colorAttachment) {
     glGenRenderbuffers(1, &m_depthStencilBuffer);
     glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilBuffer);
     glRenderbufferStorage(
-        GL_RENDERBUFFER, GL_DEPTH24_STENCIL8,
+        GL_RENDERBUFFER, depthFormat,
         colorAttachment->GetWidth(), colorAttachment->GetHeight());
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
@@ -44,6 +66,38 @@ bool Framebuffer::InitWithColorAttachment(const TexturePtr colorAttachment) {
         GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
         GL_RENDERBUFFER, m_depthStencilBuffer);
 
+    return CheckStatus();
+}
+
+bool Framebuffer::InitMultisample(int width, int height, int samples,
+    uint32_t colorFormat, uint32_t depthFormat) {
+    int maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    m_width = width;
+    m_height = height;
+    m_samples = std::min(samples, maxSamples);
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    glGenRenderbuffers(1, &m_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, colorFormat, width, height);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+        GL_RENDERBUFFER, m_colorBuffer);
+
+    glGenRenderbuffers(1, &m_depthStencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, depthFormat, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+        GL_RENDERBUFFER, m_depthStencilBuffer);
+
+    return CheckStatus();
+}
+
+bool Framebuffer::CheckStatus() const {
     auto result = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (result != GL_FRAMEBUFFER_COMPLETE) {
         SPDLOG_ERROR("failed to create framebuffer: {}", result);
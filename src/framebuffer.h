@@ -6,21 +6,38 @@
 CLASS_PTR(Framebuffer);
 class Framebuffer {
 public:
-    static FramebufferUPtr Create(const TexturePtr colorAttachment);
+    // depthFormat: GL_DEPTH24_STENCIL8, reversed-Z에는 GL_DEPTH32F_STENCIL8
+    static FramebufferUPtr Create(const TexturePtr colorAttachment,
+        uint32_t depthFormat = GL_DEPTH24_STENCIL8);
+    // color / depth 모두 multisample renderbuffer, ResolveTo로 texture가 있는 framebuffer에 옮긴다
+    static FramebufferUPtr CreateMultisample(int width, int height, int samples,
+        uint32_t colorFormat, uint32_t depthFormat);
     static void BindToDefault();
     ~Framebuffer();
 
     const uint32_t Get() const { return m_framebuffer; }
     void Bind() const;
+    // color를 target 크기에 맞춰 복사한다 (multisample이면 resolve)
+    void ResolveTo(const Framebuffer* target) const;
     const TexturePtr GetColorAttachment() const { return m_colorAttachment; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetSamples() const { return m_samples; }
 
 private:
     Framebuffer() {}
-    bool InitWithColorAttachment(const TexturePtr colorAttachment);
+    bool InitWithColorAttachment(const TexturePtr colorAttachment, uint32_t depthFormat);
+    bool InitMultisample(int width, int height, int samples,
+        uint32_t colorFormat, uint32_t depthFormat);
+    bool CheckStatus() const;
 
     uint32_t m_framebuffer { 0 };
+    uint32_t m_colorBuffer { 0 };
     uint32_t m_depthStencilBuffer { 0 };
     TexturePtr m_colorAttachment;
+    int m_width { 0 };
+    int m_height { 0 };
+    int m_samples { 0 };
 };
 
 #endif // __FRAMEBUFFER_H__
\ No newline at end of file
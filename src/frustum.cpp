@@ -0,0 +1,76 @@
+#include "frustum.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_SSE2
+#include <emmintrin.h>
+#endif
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection) {
+    // glm은 column-major이므로 i번째 row는 (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i],
+            viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    Frustum frustum;
+    frustum.m_planes[0] = row(3) + row(0);
+    frustum.m_planes[1] = row(3) - row(0);
+    frustum.m_planes[2] = row(3) + row(1);
+    frustum.m_planes[3] = row(3) - row(1);
+    frustum.m_planes[4] = row(3) + row(2);
+    frustum.m_planes[5] = row(3) - row(2);
+    for (auto& plane: frustum.m_planes) {
+        // 먼 평면이 무한대인 projection은 법선이 0인 평면이 나온다, 항상 안쪽으로 둔다
+        float length = glm::length(glm::vec3(plane));
+        plane = length > 0.0f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    return frustum;
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+    for (auto& plane: m_planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+size_t Frustum::IntersectSpheres(const float* x, const float* y, const float* z,
+    const float* radius, size_t count, uint8_t* visible) const {
+    size_t visibleCount = 0;
+    size_t i = 0;
+#ifdef FRUSTUM_SSE2
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++) {
+        planeX[p] = _mm_set1_ps(m_planes[p].x);
+        planeY[p] = _mm_set1_ps(m_planes[p].y);
+        planeZ[p] = _mm_set1_ps(m_planes[p].z);
+        planeW[p] = _mm_set1_ps(m_planes[p].w);
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+        // 평면까지의 거리가 -radius보다 작은 평면이 하나라도 있으면 밖
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(cx, planeX[p]), _mm_mul_ps(cy, planeY[p])),
+                _mm_add_ps(_mm_mul_ps(cz, planeZ[p]), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++) {
+            visible[i + lane] = (mask >> lane) & 1;
+            visibleCount += visible[i + lane];
+        }
+    }
+#endif
+    // 4개 단위로 남는 나머지, 또는 SSE2가 없을 때 전체
+    for (; i < count; i++) {
+        visible[i] = IntersectsSphere(glm::vec3(x[i], y[i], z[i]), radius[i]) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
\ No newline at end of file
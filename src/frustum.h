@@ -0,0 +1,23 @@
+#ifndef __FRUSTUM_H__
+#define __FRUSTUM_H__
+
+#include "common.h"
+
+// projection * view 행렬에서 추출한 6개의 평면 (left, right, bottom, top, near, far)
+// 평면의 법선은 frustum 안쪽을 향한다
+class Frustum {
+public:
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+    bool IntersectsSphere(const glm::vec3& center, float radius) const;
+    // 구 count개(structure-of-arrays)를 한 번에 검사해서 visible[i]에 1 / 0을 쓴다
+    // SSE2가 있으면 4개씩 검사한다, 보이는 구의 개수를 돌려준다
+    size_t IntersectSpheres(const float* x, const float* y, const float* z,
+        const float* radius, size_t count, uint8_t* visible) const;
+    const glm::vec4& GetPlane(int index) const { return m_planes[index]; }
+
+private:
+    glm::vec4 m_planes[6];
+};
+
+#endif // __FRUSTUM_H__
\ No newline at end of file
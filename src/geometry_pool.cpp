@@ -0,0 +1,177 @@
+#include "geometry_pool.h"
+#include <algorithm>
+
+std::vector<GeometryPoolWPtr> GeometryPool::s_pools;
+
+void VertexAttribFormat::SetToVertexLayout(const VertexLayout* vertexLayout) const {
+    for (auto& attrib: attribs) {
+        vertexLayout->SetAttrib(attrib.index, attrib.count,
+            attrib.type, attrib.normalized, stride, attrib.offset);
+    }
+}
+
+bool VertexAttribFormat::operator==(const VertexAttribFormat& other) const {
+    if (stride != other.stride || attribs.size() != other.attribs.size())
+        return false;
+    for (size_t i = 0; i < attribs.size(); i++) {
+        auto& a = attribs[i];
+        auto& b = other.attribs[i];
+        if (a.index != b.index || a.count != b.count || a.type != b.type ||
+            a.normalized != b.normalized || a.offset != b.offset)
+            return false;
+    }
+    return true;
+}
+
+GeometryPoolPtr GeometryPool::Get(const VertexAttribFormat& format) {
+    // 해제된 pool을 정리하면서 같은 형식을 찾는다
+    GeometryPoolPtr found;
+    for (auto it = s_pools.begin(); it != s_pools.end();) {
+        auto pool = it->lock();
+        if (!pool) {
+            it = s_pools.erase(it);
+            continue;
+        }
+        if (!found && pool->m_format == format)
+            found = pool;
+        ++it;
+    }
+    if (found)
+        return found;
+
+    auto pool = GeometryPoolPtr(new GeometryPool());
+    pool->Init(format);
+    s_pools.push_back(pool);
+    return pool;
+}
+
+void GeometryPool::Init(const VertexAttribFormat& format) {
+    m_format = format;
+    m_vertexLayout = VertexLayout::Create();
+    // buffer는 첫 Allocate에서 그 요청 크기로 만들고, 이후에는 두 배씩 키운다
+}
+
+// buffer를 새로 만들어 기존 내용을 GPU에서 복사하고 VAO가 새 buffer를 가리키게 한다
+void GeometryPool::Reserve(size_t vertexCapacity, size_t indexCapacity) {
+    // GL_ELEMENT_ARRAY_BUFFER binding은 VAO에 저장되므로 먼저 pool의 VAO를 bind 한다
+    m_vertexLayout->Bind();
+    if (vertexCapacity > m_vertexCapacity) {
+        auto vertexBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+            nullptr, m_format.stride, vertexCapacity);
+        if (m_vertexBuffer) {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_vertexBuffer->Get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->Get());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                0, 0, m_format.stride * m_vertexCapacity);
+        }
+        ReleaseRange(m_freeVertices, m_vertexCapacity, vertexCapacity - m_vertexCapacity);
+        m_vertexCapacity = vertexCapacity;
+        m_vertexBuffer = std::move(vertexBuffer);
+        m_vertexBuffer->Bind();
+        m_format.SetToVertexLayout(m_vertexLayout.get());
+    }
+    if (indexCapacity > m_indexCapacity) {
+        auto indexBuffer = Buffer::CreateWithData(GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
+            nullptr, sizeof(uint16_t), indexCapacity);
+        if (m_indexBuffer) {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_indexBuffer->Get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer->Get());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                0, 0, sizeof(uint16_t) * m_indexCapacity);
+        }
+        ReleaseRange(m_freeIndices, m_indexCapacity, indexCapacity - m_indexCapacity);
+        m_indexCapacity = indexCapacity;
+        m_indexBuffer = std::move(indexBuffer);
+        m_indexBuffer->Bind();
+    }
+}
+
+GeometryPool::Allocation GeometryPool::Allocate(const void* vertices, size_t vertexCount,
+    const uint16_t* indices, size_t indexCount) {
+    size_t vertexOffset = 0;
+    size_t indexOffset = 0;
+    if (!AllocateRange(m_freeVertices, vertexCount, vertexOffset)) {
+        Reserve(std::max(m_vertexCapacity * 2, m_vertexCapacity + vertexCount), m_indexCapacity);
+        AllocateRange(m_freeVertices, vertexCount, vertexOffset);
+    }
+    if (!AllocateRange(m_freeIndices, indexCount, indexOffset)) {
+        Reserve(m_vertexCapacity, std::max(m_indexCapacity * 2, m_indexCapacity + indexCount));
+        AllocateRange(m_freeIndices, indexCount, indexOffset);
+    }
+
+    m_vertexLayout->Bind();
+    m_vertexBuffer->Bind();
+    glBufferSubData(GL_ARRAY_BUFFER, m_format.stride * vertexOffset,
+        m_format.stride * vertexCount, vertices);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * indexOffset,
+        sizeof(uint16_t) * indexCount, indices);
+
+    Allocation allocation;
+    allocation.baseVertex = (uint32_t)vertexOffset;
+    allocation.vertexCount = (uint32_t)vertexCount;
+    allocation.firstIndex = (uint32_t)indexOffset;
+    allocation.indexCount = (uint32_t)indexCount;
+    return allocation;
+}
+
+void GeometryPool::Free(const Allocation& allocation) {
+    ReleaseRange(m_freeVertices, allocation.baseVertex, allocation.vertexCount);
+    ReleaseRange(m_freeIndices, allocation.firstIndex, allocation.indexCount);
+}
+
+size_t GeometryPool::GetMemorySize() const {
+    return m_format.stride * m_vertexCapacity + sizeof(uint16_t) * m_indexCapacity;
+}
+
+size_t GeometryPool::GetPoolCount() {
+    size_t count = 0;
+    for (auto& pool: s_pools)
+        count += pool.expired() ? 0 : 1;
+    return count;
+}
+
+size_t GeometryPool::GetTotalMemorySize() {
+    size_t size = 0;
+    for (auto& weakPool: s_pools) {
+        auto pool = weakPool.lock();
+        if (pool)
+            size += pool->GetMemorySize();
+    }
+    return size;
+}
+
+// first fit
+bool GeometryPool::AllocateRange(std::vector<FreeRange>& freeRanges, size_t count, size_t& offset) {
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->count < count)
+            continue;
+        offset = it->offset;
+        it->offset += count;
+        it->count -= count;
+        if (it->count == 0)
+            freeRanges.erase(it);
+        return true;
+    }
+    return false;
+}
+
+// 앞뒤로 붙어 있는 빈 구간과 합친다
+void GeometryPool::ReleaseRange(std::vector<FreeRange>& freeRanges, size_t offset, size_t count) {
+    if (count == 0)
+        return;
+    auto it = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset,
+        [](const FreeRange& range, size_t value) { return range.offset < value; });
+    it = freeRanges.insert(it, { offset, count });
+    auto next = it + 1;
+    if (next != freeRanges.end() && it->offset + it->count == next->offset) {
+        it->count += next->count;
+        freeRanges.erase(next);
+    }
+    if (it != freeRanges.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->count == it->offset) {
+            prev->count += it->count;
+            freeRanges.erase(it);
+        }
+    }
+}
\ No newline at end of file
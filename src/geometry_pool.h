@@ -0,0 +1,80 @@
+#ifndef __GEOMETRY_POOL_H__
+#define __GEOMETRY_POOL_H__
+
+#include "buffer.h"
+#include "vertex_layout.h"
+#include <vector>
+
+// vertex attribute 하나, VertexLayout::SetAttrib의 인자와 같다
+struct VertexAttrib {
+    uint32_t index;
+    int count;
+    uint32_t type;
+    bool normalized;
+    uint64_t offset;
+};
+
+// vertex buffer 한 개의 형식, 형식이 같은 mesh끼리 GeometryPool을 공유한다
+struct VertexAttribFormat {
+    size_t stride { 0 };
+    std::vector<VertexAttrib> attribs;
+
+    void SetToVertexLayout(const VertexLayout* vertexLayout) const;
+    bool operator==(const VertexAttribFormat& other) const;
+};
+
+// 같은 vertex 형식의 static mesh를 큰 vertex / index buffer 하나씩에 나눠 담는다
+// mesh는 baseVertex / firstIndex로 자기 영역을 그리므로 mesh를 바꿔도 VAO를 다시 bind하지 않는다
+// index는 16 bit, 첫 mesh 크기로 시작해서 공간이 모자라면 buffer를 두 배로 키워 기존 내용을 복사한다
+CLASS_PTR(GeometryPool)
+class GeometryPool {
+public:
+    // 형식이 같은 pool이 있으면 공유하고 없으면 만든다
+    // 마지막 mesh가 해제되면 pool도 해제된다
+    static GeometryPoolPtr Get(const VertexAttribFormat& format);
+
+    struct Allocation {
+        uint32_t baseVertex { 0 };
+        uint32_t vertexCount { 0 };
+        uint32_t firstIndex { 0 };
+        uint32_t indexCount { 0 };
+    };
+    Allocation Allocate(const void* vertices, size_t vertexCount,
+        const uint16_t* indices, size_t indexCount);
+    void Free(const Allocation& allocation);
+
+    const VertexLayout* GetVertexLayout() const { return m_vertexLayout.get(); }
+    size_t GetVertexCapacity() const { return m_vertexCapacity; }
+    size_t GetIndexCapacity() const { return m_indexCapacity; }
+    size_t GetMemorySize() const;
+
+    // 살아있는 pool 수와 전체 buffer 크기
+    static size_t GetPoolCount();
+    static size_t GetTotalMemorySize();
+
+private:
+    GeometryPool() {}
+    void Init(const VertexAttribFormat& format);
+    void Reserve(size_t vertexCapacity, size_t indexCapacity);
+
+    // 비어 있는 [offset, offset + count) 구간, offset 순으로 정렬
+    struct FreeRange {
+        size_t offset;
+        size_t count;
+    };
+    static bool AllocateRange(std::vector<FreeRange>& freeRanges, size_t count, size_t& offset);
+    static void ReleaseRange(std::vector<FreeRange>& freeRanges, size_t offset, size_t count);
+
+    VertexAttribFormat m_format;
+    VertexLayoutUPtr m_vertexLayout;
+    BufferUPtr m_vertexBuffer;
+    BufferUPtr m_indexBuffer;
+    size_t m_vertexCapacity { 0 };
+    size_t m_indexCapacity { 0 };
+    std::vector<FreeRange> m_freeVertices;
+    std::vector<FreeRange> m_freeIndices;
+
+    static std::vector<GeometryPoolWPtr> s_pools;
+};
+
+#endif // __GEOMETRY_POOL_H__
\ No newline at end of file
@@ -31,17 +31,33 @@ Image::~Image() {
 }
 /*보통의 이미지는 좌상단을 원점으로 함
 OpenGL은 좌하단을 원점으로 함
-이미지 로딩시 상하를 반전시켜서 문제를 해결할 수 있음*/
+이미지 로딩시 상하를 반전시켜서 문제를 해결할 수 있음
+
+여러 thread에서 동시에 load할 수 있도록 stbi_set_flip_vertically_on_load(전역 설정)
+대신 load 후에 직접 뒤집는다*/
 bool Image::LoadWithStb(const std::string& filepath, bool flipVertical) {
-    stbi_set_flip_vertically_on_load(flipVertical);
     m_data = stbi_load(filepath.c_str(), &m_width, &m_height, &m_channelCount, 0);
     if (!m_data) {
         SPDLOG_ERROR("failed to load image: {}", filepath);
         return false;
     }
+    if (flipVertical)
+        FlipVertical();
     return true;
 }
 
+void Image::FlipVertical() {
+    size_t rowSize = (size_t)m_width * m_channelCount;
+    std::vector<uint8_t> row(rowSize);
+    for (int j = 0; j < m_height / 2; j++) {
+        uint8_t* top = m_data + j * rowSize;
+        uint8_t* bottom = m_data + (m_height - 1 - j) * rowSize;
+        memcpy(row.data(), top, rowSize);
+        memcpy(top, bottom, rowSize);
+        memcpy(bottom, row.data(), rowSize);
+    }
+}
+
 void Image::SetCheckImage(int gridX, int gridY) {
     for (int j = 0; j < m_height; j++) {
         for (int i = 0; i < m_width; i++) {
@@ -18,6 +18,7 @@ public:
     int GetChannelCount() const { return m_channelCount; }
 
     void SetCheckImage(int gridX, int gridY);
+    void FlipVertical();
 
 private:
     Image() {};
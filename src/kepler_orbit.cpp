@@ -0,0 +1,170 @@
+#include "kepler_orbit.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KEPLER_ORBIT_SSE2
+#include <emmintrin.h>
+#endif
+
+// e < 0.9 정도까지는 M + e sin(M)에서 시작해 5번이면 float 정밀도로 수렴한다
+static const int kKeplerIterations = 5;
+
+KeplerOrbitTableUPtr KeplerOrbitTable::Create() {
+    return KeplerOrbitTableUPtr(new KeplerOrbitTable());
+}
+
+size_t KeplerOrbitTable::AddOrbit(const KeplerElements& elements) {
+    size_t index = GetCount();
+    float e = glm::clamp(elements.eccentricity, 0.0f, 0.99f);
+    m_meanMotion.push_back(elements.period > 0.0 ?
+        glm::two_pi<double>() / elements.period : 0.0);
+    m_meanAnomaly.push_back(elements.meanAnomaly);
+    m_semiMajorAxis.push_back(elements.semiMajorAxis);
+    m_eccentricity.push_back(e);
+    m_semiMinorAxis.push_back(elements.semiMajorAxis * sqrtf(1.0f - e * e));
+
+    // 궤도면 -> 기준면(x, y, 북극 z) 회전, world로는 (x, z, y)로 옮긴다
+    float cosO = cosf(elements.ascendingNode), sinO = sinf(elements.ascendingNode);
+    float cosW = cosf(elements.argumentOfPeriapsis), sinW = sinf(elements.argumentOfPeriapsis);
+    float cosI = cosf(elements.inclination), sinI = sinf(elements.inclination);
+    m_px.push_back(cosW * cosO - sinW * sinO * cosI);
+    m_pz.push_back(cosW * sinO + sinW * cosO * cosI);
+    m_py.push_back(sinW * sinI);
+    m_qx.push_back(-sinW * cosO - cosW * sinO * cosI);
+    m_qz.push_back(-sinW * sinO + cosW * cosO * cosI);
+    m_qy.push_back(cosW * sinI);
+    return index;
+}
+
+void KeplerOrbitTable::Reserve(size_t count) {
+    m_meanMotion.reserve(count);
+    m_meanAnomaly.reserve(count);
+    m_semiMajorAxis.reserve(count);
+    m_eccentricity.reserve(count);
+    m_semiMinorAxis.reserve(count);
+    m_px.reserve(count); m_py.reserve(count); m_pz.reserve(count);
+    m_qx.reserve(count); m_qy.reserve(count); m_qz.reserve(count);
+}
+
+void KeplerOrbitTable::Truncate(size_t count) {
+    if (count >= GetCount())
+        return;
+    m_meanMotion.resize(count);
+    m_meanAnomaly.resize(count);
+    m_semiMajorAxis.resize(count);
+    m_eccentricity.resize(count);
+    m_semiMinorAxis.resize(count);
+    m_px.resize(count); m_py.resize(count); m_pz.resize(count);
+    m_qx.resize(count); m_qy.resize(count); m_qz.resize(count);
+}
+
+bool KeplerOrbitTable::IsSimdSupported() {
+#ifdef KEPLER_ORBIT_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void KeplerOrbitTable::PropagateScalar(double time, size_t begin, size_t end,
+    float* x, float* y, float* z) const {
+    for (size_t i = begin; i < end; i++) {
+        // 평균 근점 이각은 double에서 [-pi, pi]로 접은 뒤 float로 푼다
+        double meanAnomaly = (double)m_meanAnomaly[i] + m_meanMotion[i] * time;
+        meanAnomaly -= glm::two_pi<double>() * floor(meanAnomaly / glm::two_pi<double>() + 0.5);
+        float M = (float)meanAnomaly;
+        float e = m_eccentricity[i];
+
+        float E = M + e * sinf(M);
+        for (int k = 0; k < kKeplerIterations; k++)
+            E -= (E - e * sinf(E) - M) / (1.0f - e * cosf(E));
+
+        float u = m_semiMajorAxis[i] * (cosf(E) - e);
+        float v = m_semiMinorAxis[i] * sinf(E);
+        x[i] = u * m_px[i] + v * m_qx[i];
+        y[i] = u * m_py[i] + v * m_qy[i];
+        z[i] = u * m_pz[i] + v * m_qz[i];
+    }
+}
+
+#ifdef KEPLER_ORBIT_SSE2
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// 4개의 sin, cos을 동시에 계산 (cephes sinf / cosf와 같은 다항식)
+// pi/2 단위로 사분면을 구하고 나머지 [-pi/4, pi/4] 구간에서 다항식으로 근사한다
+static inline void SinCos(__m128 x, __m128& outSin, __m128& outCos) {
+    __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(glm::two_over_pi<float>())));
+    __m128 q = _mm_cvtepi32_ps(quadrant);
+    // Cody-Waite, pi/2를 세 조각으로 나눠 빼서 정밀도를 유지한다
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)), _mm_set1_ps(8.3321608736e-3f));
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+    __m128 c = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)), _mm_set1_ps(-1.388731625493765e-3f));
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+    c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // 사분면 1, 3은 sin / cos이 바뀌고, 2, 3은 sin이, 1, 2는 cos의 부호가 바뀐다
+    __m128i one = _mm_set1_epi32(1);
+    __m128i two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+    outSin = _mm_xor_ps(Select(swap, c, s), sinSign);
+    outCos = _mm_xor_ps(Select(swap, s, c), cosSign);
+}
+
+// 평균 근점 이각 M0 + n * t를 double에서 [-pi, pi]로 접는다
+static inline __m128d WrapMeanAnomaly(__m128d meanAnomaly, __m128d meanMotion, __m128d time) {
+    __m128d m = _mm_add_pd(meanAnomaly, _mm_mul_pd(meanMotion, time));
+    __m128i turns = _mm_cvtpd_epi32(_mm_mul_pd(m, _mm_set1_pd(1.0 / glm::two_pi<double>())));
+    return _mm_sub_pd(m, _mm_mul_pd(_mm_cvtepi32_pd(turns), _mm_set1_pd(glm::two_pi<double>())));
+}
+#endif
+
+void KeplerOrbitTable::Propagate(double time, float* x, float* y, float* z) const {
+    const size_t count = GetCount();
+    size_t i = 0;
+#ifdef KEPLER_ORBIT_SSE2
+    const __m128d t = _mm_set1_pd(time);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 m0 = _mm_loadu_ps(&m_meanAnomaly[i]);
+        __m128d lo = WrapMeanAnomaly(_mm_cvtps_pd(m0), _mm_loadu_pd(&m_meanMotion[i]), t);
+        __m128d hi = WrapMeanAnomaly(_mm_cvtps_pd(_mm_movehl_ps(m0, m0)),
+            _mm_loadu_pd(&m_meanMotion[i + 2]), t);
+        __m128 M = _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+        __m128 e = _mm_loadu_ps(&m_eccentricity[i]);
+
+        __m128 sinE, cosE;
+        SinCos(M, sinE, cosE);
+        __m128 E = _mm_add_ps(M, _mm_mul_ps(e, sinE));
+        for (int k = 0; k < kKeplerIterations; k++) {
+            SinCos(E, sinE, cosE);
+            __m128 f = _mm_sub_ps(_mm_sub_ps(E, _mm_mul_ps(e, sinE)), M);
+            __m128 df = _mm_sub_ps(one, _mm_mul_ps(e, cosE));
+            E = _mm_sub_ps(E, _mm_div_ps(f, df));
+        }
+        SinCos(E, sinE, cosE);
+
+        __m128 u = _mm_mul_ps(_mm_loadu_ps(&m_semiMajorAxis[i]), _mm_sub_ps(cosE, e));
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(&m_semiMinorAxis[i]), sinE);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_mul_ps(u, _mm_loadu_ps(&m_px[i])),
+            _mm_mul_ps(v, _mm_loadu_ps(&m_qx[i]))));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(u, _mm_loadu_ps(&m_py[i])),
+            _mm_mul_ps(v, _mm_loadu_ps(&m_qy[i]))));
+        _mm_storeu_ps(z + i, _mm_add_ps(_mm_mul_ps(u, _mm_loadu_ps(&m_pz[i])),
+            _mm_mul_ps(v, _mm_loadu_ps(&m_qz[i]))));
+    }
+#endif
+    // 4개 단위로 남는 나머지, 또는 SSE2가 없을 때 전체
+    PropagateScalar(time, i, count, x, y, z);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef __KEPLER_ORBIT_H__
+#define __KEPLER_ORBIT_H__
+
+#include "common.h"
+
+// 타원 궤도 요소, 각은 모두 radian
+// 기준면은 world의 xz 평면이고 +y가 궤도 북극 방향이다
+struct KeplerElements {
+    float semiMajorAxis { 1.0f };           // a
+    float eccentricity { 0.0f };            // e, 0 <= e < 1
+    float inclination { 0.0f };             // i
+    float ascendingNode { 0.0f };           // Ω, 승교점 경도
+    float argumentOfPeriapsis { 0.0f };     // ω, 근점 인수
+    float meanAnomaly { 0.0f };             // M0, time = 0에서의 평균 근점 이각
+    double period { 0.0 };                  // 공전주기(일), 0이면 공전하지 않음
+};
+
+// 케플러 궤도 요소 테이블 (structure-of-arrays)
+// 매 프레임 M = M0 + n * t 로부터 케플러 방정식 E - e sin(E) = M 을 Newton 법으로 풀어
+// 궤도 중심 기준 위치를 구한다. SSE2가 있으면 4개씩, 없으면 scalar로 계산한다
+CLASS_PTR(KeplerOrbitTable)
+class KeplerOrbitTable {
+public:
+    static KeplerOrbitTableUPtr Create();
+
+    size_t AddOrbit(const KeplerElements& elements);
+    void Reserve(size_t count);
+    void Truncate(size_t count);
+    size_t GetCount() const { return m_semiMajorAxis.size(); }
+
+    // time(일)에서의 위치를 x, y, z 배열(GetCount()개)에 쓴다
+    void Propagate(double time, float* x, float* y, float* z) const;
+    void PropagateScalar(double time, float* x, float* y, float* z) const {
+        PropagateScalar(time, 0, GetCount(), x, y, z);
+    }
+    static bool IsSimdSupported();
+
+private:
+    KeplerOrbitTable() {}
+    void PropagateScalar(double time, size_t begin, size_t end,
+        float* x, float* y, float* z) const;
+
+    std::vector<double> m_meanMotion;       // radian / 일, 큰 time에서도 위상이 정확하도록 double
+    std::vector<float> m_meanAnomaly;
+    std::vector<float> m_semiMajorAxis;
+    std::vector<float> m_eccentricity;
+    std::vector<float> m_semiMinorAxis;     // a * sqrt(1 - e^2)
+
+    // 궤도면의 근점 방향(P)과 그에 수직인 방향(Q), i / Ω / ω는 변하지 않으므로 미리 계산
+    std::vector<float> m_px, m_py, m_pz;
+    std::vector<float> m_qx, m_qy, m_qz;
+};
+
+#endif // __KEPLER_ORBIT_H__
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFileUPtr MappedFile::Open(const std::string& filename) {
+    auto file = MappedFileUPtr(new MappedFile());
+    if (!file->Init(filename))
+        return nullptr;
+    return std::move(file);
+}
+
+#ifdef _WIN32
+MappedFile::~MappedFile() {
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file && m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+}
+
+bool MappedFile::Init(const std::string& filename) {
+    m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = (size_t)size.QuadPart;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        SPDLOG_ERROR("failed to map file: {}", filename);
+        return false;
+    }
+    m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_data) {
+        SPDLOG_ERROR("failed to map file: {}", filename);
+        return false;
+    }
+    return true;
+}
+#else
+MappedFile::~MappedFile() {
+    if (m_data)
+        munmap((void*)m_data, m_size);
+    if (m_file >= 0)
+        close(m_file);
+}
+
+bool MappedFile::Init(const std::string& filename) {
+    m_file = open(filename.c_str(), O_RDONLY);
+    if (m_file < 0) {
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return false;
+    }
+    struct stat info;
+    if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+        SPDLOG_ERROR("failed to read file size: {}", filename);
+        return false;
+    }
+    m_size = (size_t)info.st_size;
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED) {
+        SPDLOG_ERROR("failed to map file: {}", filename);
+        return false;
+    }
+    // tile은 feedback에 따라 흩어진 위치에서 읽힌다
+    madvise(data, m_size, MADV_RANDOM);
+    m_data = (const uint8_t*)data;
+    return true;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include "common.h"
+
+// 읽기 전용 memory mapped file, 필요한 부분만 OS가 page 단위로 읽어온다
+CLASS_PTR(MappedFile)
+class MappedFile {
+public:
+    static MappedFileUPtr Open(const std::string& filename);
+    ~MappedFile();
+
+    const uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    MappedFile() {}
+    bool Init(const std::string& filename);
+    const uint8_t* m_data { nullptr };
+    size_t m_size { 0 };
+#ifdef _WIN32
+    void* m_file { nullptr };
+    void* m_mapping { nullptr };
+#else
+    int m_file { -1 };
+#endif
+};
+
+#endif // __MAPPED_FILE_H__
\ No newline at end of file
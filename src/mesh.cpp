@@ -1,41 +1,336 @@
 #include "mesh.h"
+#include <cfloat>
 
 MeshUPtr Mesh::Create(
     const std::vector<Vertex>& vertices,
     const std::vector<uint32_t>& indices,
-    uint32_t primitiveType) {
+    uint32_t primitiveType,
+    VertexFormat vertexFormat) {
     auto mesh = MeshUPtr(new Mesh());
-    mesh->Init(vertices, indices, primitiveType);
+    mesh->Init(vertices, indices, primitiveType, vertexFormat);
     return std::move(mesh);
 }
 
+// AABB 중심에서 가장 먼 vertex까지를 반지름으로 한다, 최소 구는 아니지만 한 번의 순회로 끝난다
+void Mesh::ComputeBoundingSphere(const std::vector<Vertex>& vertices) {
+    if (vertices.empty())
+        return;
+    glm::vec3 minPos = vertices[0].position;
+    glm::vec3 maxPos = vertices[0].position;
+    for (auto& vertex: vertices) {
+        minPos = glm::min(minPos, vertex.position);
+        maxPos = glm::max(maxPos, vertex.position);
+    }
+    m_boundingCenter = (minPos + maxPos) * 0.5f;
+    float radius2 = 0.0f;
+    for (auto& vertex: vertices) {
+        glm::vec3 offset = vertex.position - m_boundingCenter;
+        radius2 = std::max(radius2, glm::dot(offset, offset));
+    }
+    m_boundingRadius = sqrtf(radius2);
+}
+
 void Mesh::Init(
-    const std::vector<Vertex>& vertices,
-    const std::vector<uint32_t>& indices,
-    uint32_t primitiveType) {
+    std::vector<Vertex> vertices,
+    std::vector<uint32_t> indices,
+    uint32_t primitiveType,
+    VertexFormat vertexFormat) {
+    m_primitiveType = primitiveType;
+    ComputeBoundingSphere(vertices);
     if (primitiveType == GL_TRIANGLES) {
-        ComputeTangents(const_cast<std::vector<Vertex>&>(vertices), indices);
+        ComputeTangents(vertices, indices);
+        Optimize(vertices, indices);
+    }
+    BuildMeshlets(vertices, indices);
+    m_indexCount = indices.size();
+
+    m_vertexFormat = vertexFormat;
+    std::vector<uint8_t> data;
+    VertexAttribFormat format;
+    if (m_vertexFormat == VertexFormat::Float) {
+        data.resize(sizeof(Vertex) * vertices.size());
+        memcpy(data.data(), vertices.data(), data.size());
+        format.stride = sizeof(Vertex);
+        format.attribs = {
+            { 0, 3, GL_FLOAT, false, 0 },
+            { 1, 3, GL_FLOAT, false, offsetof(Vertex, normal) },
+            { 2, 2, GL_FLOAT, false, offsetof(Vertex, texCoord) },
+            { 3, 3, GL_FLOAT, false, offsetof(Vertex, tangent) },
+        };
+    }
+    else {
+        PackCompactVertices(vertices, data, format);
+    }
+
+    // 16-bit index mesh는 같은 형식의 geometry pool에 나눠 담는다
+    if (m_indexType == GL_UNSIGNED_SHORT) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        m_geometryPool = GeometryPool::Get(format);
+        m_allocation = m_geometryPool->Allocate(data.data(), vertices.size(),
+            shortIndices.data(), shortIndices.size());
+        for (auto& meshlet: m_meshlets) {
+            meshlet.firstIndex += m_allocation.firstIndex;
+            meshlet.baseVertex += (int32_t)m_allocation.baseVertex;
+        }
+        return;
     }
 
     m_vertexLayout = VertexLayout::Create();
     m_vertexBuffer = Buffer::CreateWithData(
         GL_ARRAY_BUFFER, GL_STATIC_DRAW,
-        vertices.data(), sizeof(Vertex), vertices.size());
+        data.data(), format.stride, vertices.size());
+    format.SetToVertexLayout(m_vertexLayout.get());
     m_indexBuffer = Buffer::CreateWithData(
         GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
         indices.data(), sizeof(uint32_t), indices.size());
-    m_vertexLayout->SetAttrib(0, 3, GL_FLOAT, false, sizeof(Vertex), 0);
-    m_vertexLayout->SetAttrib(1, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
-    m_vertexLayout->SetAttrib(2, 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord));
-    m_vertexLayout->SetAttrib(3, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, tangent));
 }
 
-void Mesh::Draw(const Program* program) const {
-    m_vertexLayout->Bind();
+Mesh::~Mesh() {
+    if (m_geometryPool)
+        m_geometryPool->Free(m_allocation);
+}
+
+const VertexLayout* Mesh::GetVertexLayout() const {
+    return m_geometryPool ? m_geometryPool->GetVertexLayout() : m_vertexLayout.get();
+}
+
+// index가 16 bit에 들어가면 GL_UNSIGNED_SHORT를 쓴다
+// vertex가 더 많은 triangle list는 vertex 65536개 이하의 meshlet으로 나누고
+// meshlet마다 vertex를 따로 모아 base vertex 기준 local index로 바꾼다 (경계 vertex는 중복)
+void Mesh::BuildMeshlets(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    const size_t maxMeshletVertexCount = 65536;
+    m_meshlets.clear();
+    if (vertices.size() <= maxMeshletVertexCount) {
+        m_indexType = GL_UNSIGNED_SHORT;
+        m_meshlets.push_back({ 0, (uint32_t)indices.size(), 0 });
+        return;
+    }
+    if (m_primitiveType != GL_TRIANGLES) {
+        m_indexType = GL_UNSIGNED_INT;
+        m_meshlets.push_back({ 0, (uint32_t)indices.size(), 0 });
+        return;
+    }
+
+    std::vector<Vertex> meshletVertices;
+    meshletVertices.reserve(vertices.size());
+    std::vector<int32_t> localIndex(vertices.size(), -1);
+    std::vector<uint32_t> used;
+    Meshlet meshlet = { 0, 0, 0 };
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        size_t newCount = 0;
+        for (int k = 0; k < 3; k++) {
+            auto v = indices[i + k];
+            bool repeated = (k > 0 && v == indices[i]) || (k > 1 && v == indices[i + 1]);
+            if (localIndex[v] < 0 && !repeated)
+                newCount++;
+        }
+        if (used.size() + newCount > maxMeshletVertexCount) {
+            m_meshlets.push_back(meshlet);
+            for (auto v: used)
+                localIndex[v] = -1;
+            used.clear();
+            meshlet = { (uint32_t)i, 0, (int32_t)meshletVertices.size() };
+        }
+        for (int k = 0; k < 3; k++) {
+            auto v = indices[i + k];
+            if (localIndex[v] < 0) {
+                localIndex[v] = (int32_t)used.size();
+                used.push_back(v);
+                meshletVertices.push_back(vertices[v]);
+            }
+            indices[i + k] = (uint32_t)localIndex[v];
+        }
+        meshlet.indexCount += 3;
+    }
+    m_meshlets.push_back(meshlet);
+    vertices.swap(meshletVertices);
+    m_indexType = GL_UNSIGNED_SHORT;
+    SPDLOG_INFO("mesh split into {} meshlets, {} vertices", m_meshlets.size(), vertices.size());
+}
+
+// 생성 순서대로인 index를 vertex cache에 맞게 다시 정렬하고
+// vertex도 index에서 처음 쓰이는 순서로 옮겨서 vertex fetch가 순차적이 되게 한다
+void Mesh::Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    m_cacheStatsBefore = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+    MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+    auto remap = MeshOptimizer::OptimizeVertexFetch(indices, vertices.size());
+    std::vector<Vertex> reordered(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+        reordered[remap[i]] = vertices[i];
+    vertices.swap(reordered);
+    m_cacheStats = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+    SPDLOG_INFO("mesh optimized: {} vertices, {} triangles, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+        vertices.size(), indices.size() / 3,
+        m_cacheStatsBefore.acmr, m_cacheStats.acmr,
+        m_cacheStatsBefore.atvr, m_cacheStats.atvr);
+}
+
+// 단위 vector를 octahedron에 투영해서 펼친 2 성분 (-1 ~ 1)
+static glm::vec2 OctEncode(const glm::vec3& v) {
+    float sum = fabsf(v.x) + fabsf(v.y) + fabsf(v.z);
+    // 길이가 0이거나 NaN인 tangent는 +z로 둔다
+    if (!(sum > 0.0f))
+        return glm::vec2(0.0f);
+    glm::vec2 e = glm::vec2(v.x, v.y) / sum;
+    if (v.z < 0.0f) {
+        e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) *
+            glm::vec2(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return e;
+}
+
+static int16_t PackSnorm16(float value) {
+    return (int16_t)roundf(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+static uint16_t PackUnorm16(float value) {
+    return (uint16_t)roundf(glm::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+// 16-bit float, 범위를 넘는 값은 inf, 너무 작은 값은 0이 된다
+static uint16_t PackHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent <= 0)
+        return (uint16_t)sign;
+    if (exponent >= 31)
+        return (uint16_t)(sign | 0x7c00);
+    return (uint16_t)(sign | (exponent << 10) | (mantissa >> 13));
+}
+
+// position(float 또는 AABB 기준 unorm16) + normal / tangent(octahedral snorm16) + uv
+// uv가 모두 [0, 1] 안에 있으면 unorm16, 아니면 (반복되는 uv) half float
+void Mesh::PackCompactVertices(const std::vector<Vertex>& vertices,
+    std::vector<uint8_t>& data, VertexAttribFormat& format) {
+    bool quantized = m_vertexFormat == VertexFormat::CompactQuantized;
+    glm::vec3 minPos = glm::vec3(FLT_MAX);
+    glm::vec3 maxPos = glm::vec3(-FLT_MAX);
+    bool unormTexCoord = true;
+    for (auto& vertex: vertices) {
+        minPos = glm::min(minPos, vertex.position);
+        maxPos = glm::max(maxPos, vertex.position);
+        unormTexCoord = unormTexCoord &&
+            vertex.texCoord.x >= 0.0f && vertex.texCoord.x <= 1.0f &&
+            vertex.texCoord.y >= 0.0f && vertex.texCoord.y <= 1.0f;
+    }
+    if (quantized && !vertices.empty()) {
+        m_positionOffset = minPos;
+        m_positionScale = maxPos - minPos;
+    }
+
+    // 4 byte 정렬을 위해 quantized position은 w 자리를 비워둔다
+    size_t positionSize = quantized ? sizeof(uint16_t) * 4 : sizeof(float) * 3;
+    size_t normalOffset = positionSize;
+    size_t tangentOffset = normalOffset + sizeof(int16_t) * 2;
+    size_t texCoordOffset = tangentOffset + sizeof(int16_t) * 2;
+    size_t stride = texCoordOffset + sizeof(uint16_t) * 2;
+
+    data.assign(stride * vertices.size(), 0);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        auto& vertex = vertices[i];
+        uint8_t* dst = data.data() + stride * i;
+        if (quantized) {
+            uint16_t position[3];
+            for (int k = 0; k < 3; k++) {
+                float range = m_positionScale[k];
+                position[k] = PackUnorm16(range > 0.0f ?
+                    (vertex.position[k] - m_positionOffset[k]) / range : 0.0f);
+            }
+            memcpy(dst, position, sizeof(position));
+        }
+        else {
+            memcpy(dst, glm::value_ptr(vertex.position), sizeof(float) * 3);
+        }
+
+        auto normal = OctEncode(vertex.normal);
+        auto tangent = OctEncode(vertex.tangent);
+        int16_t packedNormal[4] = {
+            PackSnorm16(normal.x), PackSnorm16(normal.y),
+            PackSnorm16(tangent.x), PackSnorm16(tangent.y),
+        };
+        memcpy(dst + normalOffset, packedNormal, sizeof(packedNormal));
+
+        uint16_t texCoord[2];
+        for (int k = 0; k < 2; k++) {
+            texCoord[k] = unormTexCoord ?
+                PackUnorm16(vertex.texCoord[k]) : PackHalf(vertex.texCoord[k]);
+        }
+        memcpy(dst + texCoordOffset, texCoord, sizeof(texCoord));
+    }
+
+    format.stride = stride;
+    format.attribs = {
+        quantized ? VertexAttrib { 0, 3, GL_UNSIGNED_SHORT, true, 0 } :
+            VertexAttrib { 0, 3, GL_FLOAT, false, 0 },
+        { 1, 2, GL_SHORT, true, normalOffset },
+        { 2, 2, unormTexCoord ? (uint32_t)GL_UNSIGNED_SHORT : (uint32_t)GL_HALF_FLOAT,
+            unormTexCoord, texCoordOffset },
+        { 3, 2, GL_SHORT, true, tangentOffset },
+    };
+}
+
+// vertex_input.glsl의 vertexFormat 등, 같은 program으로 다른 format의 mesh도 그리므로 매번 설정한다
+void Mesh::SetVertexFormatToProgram(const Program* program, const MeshUniforms& uniforms) const {
+    int flags = 0;
+    if (m_vertexFormat != VertexFormat::Float)
+        flags |= 1;
+    if (m_vertexFormat == VertexFormat::CompactQuantized) {
+        flags |= 2;
+        program->SetUniform(uniforms.vertexPositionScale, m_positionScale);
+        program->SetUniform(uniforms.vertexPositionOffset, m_positionOffset);
+    }
+    program->SetUniform(uniforms.vertexFormat, flags);
+}
+
+void Mesh::Draw(const Program* program, const MeshUniforms& uniforms) const {
+    auto vertexLayout = GetVertexLayout();
+    vertexLayout->Bind();
+    SetVertexFormatToProgram(program, uniforms);
     if (m_material) {
-        m_material->SetToProgram(program);
+        m_material->SetToProgram(program, uniforms.material);
+    }
+    size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    for (auto& meshlet: m_meshlets) {
+        glDrawElementsBaseVertex(m_primitiveType, meshlet.indexCount, m_indexType,
+            (const void*)(meshlet.firstIndex * indexSize), meshlet.baseVertex);
+    }
+}
+
+// instanceBuffer는 instance마다 glm::mat4 model transform을 담고 있으며
+// vertex shader의 location 4~7 (mat4)로 전달된다
+void Mesh::DrawInstanced(const Program* program, const MeshUniforms& uniforms,
+    const Buffer* instanceBuffer, size_t firstInstance, size_t instanceCount) const {
+    if (instanceCount == 0)
+        return;
+    auto vertexLayout = GetVertexLayout();
+    vertexLayout->Bind();
+    SetVertexFormatToProgram(program, uniforms);
+    if (m_material) {
+        m_material->SetToProgram(program, uniforms.material);
+    }
+
+    instanceBuffer->Bind();
+    size_t stride = instanceBuffer->GetStride();
+    uint64_t offset = firstInstance * stride;
+    for (uint32_t i = 0; i < 4; i++) {
+        vertexLayout->SetAttrib(4 + i, 4, GL_FLOAT, false,
+            stride, offset + sizeof(glm::vec4) * i);
+        vertexLayout->SetAttribDivisor(4 + i, 1);
+    }
+    size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    for (auto& meshlet: m_meshlets) {
+        glDrawElementsInstancedBaseVertex(m_primitiveType, meshlet.indexCount, m_indexType,
+            (const void*)(meshlet.firstIndex * indexSize), (GLsizei)instanceCount,
+            meshlet.baseVertex);
+    }
+    // pool VAO는 instancing하지 않는 mesh도 같이 쓰므로 instance attrib을 남겨두지 않는다
+    for (uint32_t i = 0; i < 4; i++) {
+        vertexLayout->SetAttribDivisor(4 + i, 0);
+        vertexLayout->DisableAttrib(4 + i);
     }
-    glDrawElements(m_primitiveType, m_indexBuffer->GetCount(), GL_UNSIGNED_INT, 0);
 }
 
 MeshUPtr Mesh::CreateBox() {
@@ -98,7 +393,8 @@ MeshUPtr Mesh::CreatePlane() {
     return Create(vertices, indices, GL_TRIANGLES);
 }
 
-MeshUPtr Mesh::CreateSphere(uint32_t latiSegmentCount, uint32_t longiSegmentCount) {
+MeshUPtr Mesh::CreateSphere(uint32_t latiSegmentCount, uint32_t longiSegmentCount,
+    VertexFormat vertexFormat) {
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
 
@@ -137,25 +433,42 @@ MeshUPtr Mesh::CreateSphere(uint32_t latiSegmentCount, uint32_t longiSegmentCoun
         }
   }
 
-  return Create(vertices, indices, GL_TRIANGLES);
+  return Create(vertices, indices, GL_TRIANGLES, vertexFormat);
+}
+
+MaterialUniforms MaterialUniforms::Find(const Program* program) {
+    MaterialUniforms uniforms;
+    uniforms.diffuse = program->GetUniformId("material.diffuse");
+    uniforms.specular = program->GetUniformId("material.specular");
+    uniforms.shininess = program->GetUniformId("material.shininess");
+    return uniforms;
+}
+
+MeshUniforms MeshUniforms::Find(const Program* program) {
+    MeshUniforms uniforms;
+    uniforms.vertexFormat = program->GetUniformId("vertexFormat");
+    uniforms.vertexPositionScale = program->GetUniformId("vertexPositionScale");
+    uniforms.vertexPositionOffset = program->GetUniformId("vertexPositionOffset");
+    uniforms.material = MaterialUniforms::Find(program);
+    return uniforms;
 }
 
-void Material::SetToProgram(const Program* program) const {
+void Material::SetToProgram(const Program* program, const MaterialUniforms& uniforms) const {
     int textureCount = 0;
     if (diffuse) {
         glActiveTexture(GL_TEXTURE0 + textureCount);
-        program->SetUniform("material.diffuse", textureCount);
+        program->SetUniform(uniforms.diffuse, textureCount);
         diffuse->Bind();
         textureCount++;
     }
     if (specular) {
         glActiveTexture(GL_TEXTURE0 + textureCount);
-        program->SetUniform("material.specular", textureCount);
+        program->SetUniform(uniforms.specular, textureCount);
         specular->Bind();
         textureCount++;
     }
     glActiveTexture(GL_TEXTURE0);
-    program->SetUniform("material.shininess", shininess);
+    program->SetUniform(uniforms.shininess, shininess);
 }
 
 void Mesh::ComputeTangents(
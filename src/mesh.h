@@ -6,6 +6,8 @@
 #include "vertex_layout.h"
 #include "texture.h"
 #include "program.h"
+#include "mesh_optimizer.h"
+#include "geometry_pool.h"
 
 struct Vertex {
     glm::vec3 position;
@@ -14,6 +16,31 @@ struct Vertex {
     glm::vec3 tangent;
 };
 
+// GPU vertex buffer에 저장하는 형식, compact format은
+// shader/include/vertex_input.glsl을 쓰는 shader로 그려야 한다
+enum class VertexFormat {
+    Float,              // Vertex 그대로 (44 bytes)
+    Compact,            // normal / tangent octahedral snorm16, uv 16-bit (24 bytes)
+    CompactQuantized,   // Compact + position을 AABB 기준 unorm16으로 (20 bytes)
+};
+
+// Material::SetToProgram이 설정하는 uniform, program을 link한 뒤 한 번 찾아둔다
+struct MaterialUniforms {
+    UniformId diffuse;
+    UniformId specular;
+    UniformId shininess;
+    static MaterialUniforms Find(const Program* program);
+};
+
+// Mesh::Draw가 설정하는 uniform (vertex_input.glsl, material)
+struct MeshUniforms {
+    UniformId vertexFormat;
+    UniformId vertexPositionScale;
+    UniformId vertexPositionOffset;
+    MaterialUniforms material;
+    static MeshUniforms Find(const Program* program);
+};
+
 CLASS_PTR(Material);
 class Material {
 public:
@@ -24,7 +51,7 @@ public:
     TexturePtr specular;
     float shininess { 32.0f };
 
-    void SetToProgram(const Program* program) const;
+    void SetToProgram(const Program* program, const MaterialUniforms& uniforms) const;
 
 private:
     Material() {}
@@ -36,32 +63,74 @@ public:
     static MeshUPtr Create(
         const std::vector<Vertex>& vertices,
         const std::vector<uint32_t>& indices,
-        uint32_t primitiveType);
+        uint32_t primitiveType,
+        VertexFormat vertexFormat = VertexFormat::Float);
     static MeshUPtr CreateBox();
     static MeshUPtr CreatePlane();
-    static MeshUPtr CreateSphere(uint32_t latiSegmentCount = 16, uint32_t longiSegmentCount = 32);
+    static MeshUPtr CreateSphere(uint32_t latiSegmentCount = 16, uint32_t longiSegmentCount = 32,
+        VertexFormat vertexFormat = VertexFormat::Float);
 
-    const VertexLayout* GetVertexLayout() const {
-        return m_vertexLayout.get();
-    }
-    BufferPtr GetVertexBuffer() const { return m_vertexBuffer; }
-    BufferPtr GetIndexBuffer() const { return m_indexBuffer; }
+    ~Mesh();
+
+    // geometry pool에 있는 mesh는 pool의 VAO를 돌려준다
+    const VertexLayout* GetVertexLayout() const;
+    GeometryPoolPtr GetGeometryPool() const { return m_geometryPool; }
+    size_t GetIndexCount() const { return m_indexCount; }
+    VertexFormat GetVertexFormat() const { return m_vertexFormat; }
+    // index 정렬 전 / 후의 vertex cache 효율 (triangle list만)
+    const VertexCacheStats& GetCacheStatsBefore() const { return m_cacheStatsBefore; }
+    const VertexCacheStats& GetCacheStats() const { return m_cacheStats; }
+    // GL_UNSIGNED_SHORT 또는 GL_UNSIGNED_INT
+    uint32_t GetIndexType() const { return m_indexType; }
+    size_t GetMeshletCount() const { return m_meshlets.size(); }
+    // 모든 vertex를 감싸는 구 (model 공간), culling에 사용
+    const glm::vec3& GetBoundingCenter() const { return m_boundingCenter; }
+    float GetBoundingRadius() const { return m_boundingRadius; }
 
     void SetMaterial(MaterialPtr material) { m_material = material; }
     MaterialPtr GetMaterial() const { return m_material; }
 
-    void Mesh::Draw(const Program* program) const;
+    void Draw(const Program* program, const MeshUniforms& uniforms) const;
+    void DrawInstanced(const Program* program, const MeshUniforms& uniforms,
+        const Buffer* instanceBuffer, size_t firstInstance, size_t instanceCount) const;
     
     static void ComputeTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
 private:
     Mesh() {}
     void Init(
-        const std::vector<Vertex>& vertices,
-        const std::vector<uint32_t>& indices,
-        uint32_t primitiveType);
+        std::vector<Vertex> vertices,
+        std::vector<uint32_t> indices,
+        uint32_t primitiveType,
+        VertexFormat vertexFormat);
+    void Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+    void BuildMeshlets(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+    void PackCompactVertices(const std::vector<Vertex>& vertices,
+        std::vector<uint8_t>& data, VertexAttribFormat& format);
+    void SetVertexFormatToProgram(const Program* program, const MeshUniforms& uniforms) const;
+    void ComputeBoundingSphere(const std::vector<Vertex>& vertices);
 
     uint32_t m_primitiveType { GL_TRIANGLES };
+    uint32_t m_indexType { GL_UNSIGNED_INT };
+    // index buffer의 [firstIndex, firstIndex + indexCount)를 baseVertex 기준으로 그린다
+    struct Meshlet {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t baseVertex;
+    };
+    std::vector<Meshlet> m_meshlets;
+    VertexFormat m_vertexFormat { VertexFormat::Float };
+    // quantized position = unorm * scale + offset
+    glm::vec3 m_positionScale { glm::vec3(1.0f) };
+    glm::vec3 m_positionOffset { glm::vec3(0.0f) };
+    VertexCacheStats m_cacheStatsBefore;
+    VertexCacheStats m_cacheStats;
+    size_t m_indexCount { 0 };
+    glm::vec3 m_boundingCenter { glm::vec3(0.0f) };
+    float m_boundingRadius { 0.0f };
+    GeometryPoolPtr m_geometryPool;
+    GeometryPool::Allocation m_allocation;
+    // pool에 넣을 수 없는 32-bit index mesh만 따로 가진다
     VertexLayoutUPtr m_vertexLayout;
     BufferPtr m_vertexBuffer;
     BufferPtr m_indexBuffer;
@@ -0,0 +1,33 @@
+#include "mesh_lod.h"
+
+MeshLodUPtr MeshLod::CreateSphere(uint32_t minLatiSegmentCount, uint32_t maxLatiSegmentCount,
+    VertexFormat vertexFormat) {
+    auto lod = MeshLodUPtr(new MeshLod());
+    for (uint32_t lati = minLatiSegmentCount; lati <= maxLatiSegmentCount; lati *= 2) {
+        lod->m_meshes.push_back(Mesh::CreateSphere(lati, lati * 2, vertexFormat));
+        // 한 변이 pi / lati인 사각형 면의 중심이 구 표면에서 가장 멀다 (대각선 기준)
+        float halfAngle = glm::pi<float>() / (float)lati * 0.5f * glm::root_two<float>();
+        lod->m_errors.push_back(1.0f - cosf(halfAngle));
+    }
+    return std::move(lod);
+}
+
+int MeshLod::FindLevel(const Mesh* mesh) const {
+    for (size_t i = 0; i < m_meshes.size(); i++) {
+        if (m_meshes[i].get() == mesh)
+            return (int)i;
+    }
+    return -1;
+}
+
+int MeshLod::SelectLevel(float radiusInPixels, float maxPixelError, int currentLevel) const {
+    int last = (int)m_meshes.size() - 1;
+    int level = 0;
+    while (level < last && m_errors[level] * radiusInPixels > maxPixelError)
+        level++;
+    // 경계 근처에서 프레임마다 level이 바뀌지 않도록 거친 쪽으로는 여유가 있을 때만 내려간다
+    if (currentLevel >= 0 && level < currentLevel &&
+        m_errors[level] * radiusInPixels > maxPixelError * 0.75f)
+        level = currentLevel;
+    return level;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef __MESH_LOD_H__
+#define __MESH_LOD_H__
+
+#include "mesh.h"
+
+// 같은 모양을 해상도만 다르게 만든 mesh 묶음, level 0이 가장 거칠다
+// 화면에 투영된 크기에서 기하 오차가 허용 픽셀 이하인 가장 거친 level을 고른다
+CLASS_PTR(MeshLod)
+class MeshLod {
+public:
+    // 위도 분할 minLatiSegmentCount부터 maxLatiSegmentCount까지 두 배씩 (경도는 위도의 두 배)
+    static MeshLodUPtr CreateSphere(uint32_t minLatiSegmentCount, uint32_t maxLatiSegmentCount,
+        VertexFormat vertexFormat = VertexFormat::Float);
+
+    size_t GetLevelCount() const { return m_meshes.size(); }
+    MeshPtr GetMesh(size_t level) const { return m_meshes[level]; }
+    // mesh가 이 LOD의 몇 번째 level인지, 아니면 -1
+    int FindLevel(const Mesh* mesh) const;
+    // radiusInPixels: 화면에서 본 반지름, currentLevel: 지난 프레임의 level (없으면 -1)
+    int SelectLevel(float radiusInPixels, float maxPixelError, int currentLevel = -1) const;
+
+private:
+    MeshLod() {}
+    std::vector<MeshPtr> m_meshes;
+    std::vector<float> m_errors;    // 반지름 1 기준 level별 최대 기하 오차
+};
+
+#endif // __MESH_LOD_H__
\ No newline at end of file
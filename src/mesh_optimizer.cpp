@@ -0,0 +1,163 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+    size_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0)
+        return stats;
+
+    // vertex가 cache에 들어간 시점, time - timestamp > cacheSize 이면 이미 밀려난 것
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    size_t usedCount = 0;
+    std::vector<uint8_t> used(vertexCount, 0);
+    for (auto index: indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            misses++;
+        }
+        if (!used[index]) {
+            used[index] = 1;
+            usedCount++;
+        }
+    }
+    stats.acmr = (float)misses / (float)(indices.size() / 3);
+    stats.atvr = (float)misses / (float)usedCount;
+    return stats;
+}
+
+// Forsyth, "Linear-Speed Vertex Cache Optimisation"의 점수 함수
+static const int kForsythCacheSize = 32;
+
+static float ForsythVertexScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0)
+        return -1.0f;
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // 방금 그린 triangle의 vertex는 다음 triangle이 바로 쓰기 어렵도록 고정값
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = powf(1.0f - (float)(cachePosition - 3) / (kForsythCacheSize - 3), 1.5f);
+    }
+    // 남은 triangle이 적은 vertex를 먼저 끝내서 고립된 triangle이 남지 않게 한다
+    score += 2.0f * powf((float)remainingTriangles, -0.5f);
+    return score;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+
+    // vertex -> 인접 triangle 목록, remaining[v] 개가 아직 그려지지 않은 triangle
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (auto index: indices)
+        adjacencyOffset[index + 1]++;
+    for (size_t i = 0; i < vertexCount; i++)
+        adjacencyOffset[i + 1] += adjacencyOffset[i];
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            auto v = indices[t * 3 + k];
+            adjacency[adjacencyOffset[v] + remaining[v]++] = (uint32_t)t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3]] +
+            vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(kForsythCacheSize + 3);
+    newCache.reserve(kForsythCacheSize + 3);
+    size_t nextCandidate = 0;
+    int64_t best = (int64_t)(std::max_element(triangleScore.begin(), triangleScore.end()) -
+        triangleScore.begin());
+
+    while (output.size() < indices.size()) {
+        // cache 주변에 남은 triangle이 없으면 아직 안 그린 다음 triangle부터 시작
+        if (best < 0) {
+            while (emitted[nextCandidate])
+                nextCandidate++;
+            best = (int64_t)nextCandidate;
+        }
+        const uint32_t* triangle = indices.data() + best * 3;
+        emitted[best] = 1;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // 그린 triangle을 각 vertex의 남은 목록에서 뺀다
+        for (int k = 0; k < 3; k++) {
+            auto v = triangle[k];
+            uint32_t* list = adjacency.data() + adjacencyOffset[v];
+            auto it = std::find(list, list + remaining[v], (uint32_t)best);
+            std::swap(*it, list[remaining[v] - 1]);
+            remaining[v]--;
+        }
+
+        // LRU: 방금 그린 vertex가 앞으로 오고 나머지는 뒤로 밀린다
+        newCache.assign(triangle, triangle + 3);
+        for (auto v: cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache.push_back(v);
+        }
+        for (size_t i = kForsythCacheSize; i < newCache.size(); i++)
+            cachePosition[newCache[i]] = -1;
+        std::swap(cache, newCache);
+
+        // cache 안팎으로 움직인 vertex의 점수를 다시 계산하고 인접 triangle에 반영
+        float bestScore = -1.0f;
+        best = -1;
+        for (size_t i = 0; i < cache.size(); i++) {
+            auto v = cache[i];
+            int position = i < (size_t)kForsythCacheSize ? (int)i : -1;
+            cachePosition[v] = position;
+            float score = ForsythVertexScore(position, remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            const uint32_t* list = adjacency.data() + adjacencyOffset[v];
+            for (uint32_t j = 0; j < remaining[v]; j++) {
+                auto t = list[j];
+                triangleScore[t] += delta;
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+        if (cache.size() > kForsythCacheSize)
+            cache.resize(kForsythCacheSize);
+    }
+    indices.swap(output);
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& indices,
+    size_t vertexCount) {
+    const uint32_t unused = UINT32_MAX;
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+    for (auto& index: indices) {
+        if (remap[index] == unused)
+            remap[index] = next++;
+        index = remap[index];
+    }
+    // index가 가리키지 않는 vertex는 뒤에 원래 순서대로 둔다
+    for (auto& newIndex: remap) {
+        if (newIndex == unused)
+            newIndex = next++;
+    }
+    return remap;
+}
\ No newline at end of file
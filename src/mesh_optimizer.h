@@ -0,0 +1,27 @@
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+#include "common.h"
+#include <vector>
+
+// triangle list index buffer의 post-transform vertex cache 효율
+struct VertexCacheStats {
+    float acmr { 0.0f };    // triangle당 vertex shader 실행 수 (0.5 ~ 3)
+    float atvr { 0.0f };    // 사용된 vertex당 vertex shader 실행 수 (1이 최적)
+};
+
+// Mesh::Init에서 index buffer를 올리기 전에 한 번 실행하는 정렬 pass
+class MeshOptimizer {
+public:
+    // cacheSize 크기의 FIFO cache로 시뮬레이션
+    static VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+        size_t vertexCount, uint32_t cacheSize = 16);
+    // Forsyth의 linear-speed vertex cache optimization으로 triangle 순서를 바꾼다
+    static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+    // index에서 처음 쓰이는 순서대로 vertex 번호를 다시 매긴다
+    // indices는 새 번호로 바뀌고, 반환값은 old index -> new index
+    static std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices,
+        size_t vertexCount);
+};
+
+#endif // __MESH_OPTIMIZER_H__
\ No newline at end of file
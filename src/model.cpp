@@ -1,13 +1,16 @@
 #include "model.h"
+#include <algorithm>
 
-ModelUPtr Model::Load(const std::string& filename) {
+ModelUPtr Model::Load(const std::string& filename, TextureCache* textureCache,
+  VertexFormat vertexFormat) {
   auto model = ModelUPtr(new Model());
-  if (!model->LoadByAssimp(filename))
+  model->m_vertexFormat = vertexFormat;
+  if (!model->LoadByAssimp(filename, textureCache))
     return nullptr;
   return std::move(model);
 }
 
-bool Model::LoadByAssimp(const std::string& filename) {
+bool Model::LoadByAssimp(const std::string& filename, TextureCache* textureCache) {
     Assimp::Importer importer;
     auto scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs);
 
@@ -16,26 +19,45 @@ bool Model::LoadByAssimp(const std::string& filename) {
         return false;
     }
 
+    // 공유 cache가 없어도 model 안에서 같은 파일은 한 번만 읽는다
+    TextureCacheUPtr localCache;
+    if (!textureCache) {
+        localCache = TextureCache::Create();
+        textureCache = localCache.get();
+    }
+
     auto dirname = filename.substr(0, filename.find_last_of("/"));
-    auto LoadTexture = [&](aiMaterial* material, aiTextureType type) -> TexturePtr {
+    auto LoadTexture = [&](aiMaterial* material, aiTextureType type, bool srgb) -> TexturePtr {
         if (material->GetTextureCount(type) <= 0)
             return nullptr;
         aiString filepath;
-        material->GetTexture(aiTextureType_DIFFUSE, 0, &filepath);
-        auto image = Image::Load(fmt::format("{}/{}", dirname, filepath.C_Str()));
-        if (!image)
-            return nullptr;
-        return Texture::CreateFromImage(image.get());
+        material->GetTexture(type, 0, &filepath);
+        return textureCache->Load(fmt::format("{}/{}", dirname, filepath.C_Str()), srgb);
     };
 
     for (uint32_t i = 0; i < scene->mNumMaterials; i++) {
         auto material = scene->mMaterials[i];
-        auto glMaterial = Material::Create();
-        glMaterial->diffuse = LoadTexture(material, aiTextureType_DIFFUSE);
-        glMaterial->specular = LoadTexture(material, aiTextureType_SPECULAR);
+        // diffuse는 색상, specular는 세기 값이므로 sRGB 변환하지 않는다
+        auto diffuse = LoadTexture(material, aiTextureType_DIFFUSE, true);
+        auto specular = LoadTexture(material, aiTextureType_SPECULAR, false);
+
+        // texture 조합이 같은 material은 하나로 합쳐 instance batch가 나뉘지 않게 한다
+        auto duplicate = std::find_if(m_materials.begin(), m_materials.end(),
+            [&](const MaterialPtr& m) { return m->diffuse == diffuse && m->specular == specular; });
+        if (duplicate != m_materials.end()) {
+            m_materials.push_back(*duplicate);
+            continue;
+        }
+        MaterialPtr glMaterial = Material::Create();
+        glMaterial->diffuse = diffuse;
+        glMaterial->specular = specular;
         m_materials.push_back(std::move(glMaterial));
     }
 
+    auto& stats = textureCache->GetStats();
+    SPDLOG_INFO("texture cache: {} hits, {} misses, {} KB saved",
+        stats.hits, stats.misses, stats.bytesSaved / 1024);
+
     ProcessNode(scene->mRootNode, scene);
     return true;
 }
@@ -73,14 +95,14 @@ void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
         indices[3*i+2] = mesh->mFaces[i].mIndices[2];
     }
 
-    auto glMesh = Mesh::Create(vertices, indices, GL_TRIANGLES);
+    auto glMesh = Mesh::Create(vertices, indices, GL_TRIANGLES, m_vertexFormat);
     if (mesh->mMaterialIndex >= 0)
         glMesh->SetMaterial(m_materials[mesh->mMaterialIndex]);
     m_meshes.push_back(std::move(glMesh));
 }
 
-void Model::Draw(const Program* program) const {
+void Model::Draw(const Program* program, const MeshUniforms& uniforms) const {
   for (auto& mesh: m_meshes) {
-    mesh->Draw(program);
+    mesh->Draw(program, uniforms);
   }
 }
\ No newline at end of file
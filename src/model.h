@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include "mesh.h"
+#include "texture_cache.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -11,20 +12,23 @@
 CLASS_PTR(Model);
 class Model {
 public:
-    static ModelUPtr Load(const std::string& filename);
+    // textureCache를 넘기면 다른 model / context와 texture를 공유한다
+    static ModelUPtr Load(const std::string& filename, TextureCache* textureCache = nullptr,
+        VertexFormat vertexFormat = VertexFormat::Float);
 
     int GetMeshCount() const { return (int)m_meshes.size(); }
     MeshPtr GetMesh(int index) const { return m_meshes[index]; }
-    void Model::Draw(const Program* program) const;
+    void Draw(const Program* program, const MeshUniforms& uniforms) const;
 
 private:
     Model() {}
-    bool LoadByAssimp(const std::string& filename);
+    bool LoadByAssimp(const std::string& filename, TextureCache* textureCache);
     void ProcessMesh(aiMesh* mesh, const aiScene* scene);
     void ProcessNode(aiNode* node, const aiScene* scene);
 
     std::vector<MeshPtr> m_meshes;
     std::vector<MaterialPtr> m_materials;
+    VertexFormat m_vertexFormat { VertexFormat::Float };
 };
 
 #endif // __MODEL_H__
\ No newline at end of file
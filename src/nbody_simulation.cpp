@@ -0,0 +1,422 @@
+#include "nbody_simulation.h"
+#include <algorithm>
+#include <chrono>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NBODY_SIMULATION_SSE2
+#include <emmintrin.h>
+#endif
+
+// morton code는 축마다 14 bit, 남은 22 bit에 천체 index를 넣어 한 번의 정수 정렬로 끝낸다
+static const int kMortonBits = 14;
+static const int kIndexBits = 22;
+static const uint64_t kIndexMask = ((uint64_t)1 << kIndexBits) - 1;
+static const uint32_t kLeafSize = 8;
+static const uint32_t kGroupSize = 64;
+static const size_t kGrainSize = 1024;
+
+static uint64_t SpreadBits(uint32_t v) {
+    // 14 bit를 3칸 간격으로 벌린다
+    uint64_t x = v & 0x3fff;
+    x = (x | (x << 16)) & 0x0000ff0000ffull;
+    x = (x | (x << 8)) & 0x00f00f00f00full;
+    x = (x | (x << 4)) & 0x0c30c30c30c3ull;
+    x = (x | (x << 2)) & 0x249249249249ull;
+    return x;
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - begin).count();
+}
+
+NBodySimulationUPtr NBodySimulation::Create(ThreadPool* pool) {
+    auto simulation = NBodySimulationUPtr(new NBodySimulation());
+    simulation->m_pool = pool;
+    return std::move(simulation);
+}
+
+void NBodySimulation::Clear() {
+    m_x.clear(); m_y.clear(); m_z.clear();
+    m_vx.clear(); m_vy.clear(); m_vz.clear();
+    m_ax.clear(); m_ay.clear(); m_az.clear();
+    m_mass.clear();
+    m_order.clear();
+    m_accelerationValid = false;
+}
+
+size_t NBodySimulation::AddBody(const glm::dvec3& position, const glm::vec3& velocity, float mass) {
+    size_t index = GetCount();
+    if (index > kIndexMask) {
+        SPDLOG_ERROR("too many n-body bodies: {}", index);
+        return index;
+    }
+    m_x.push_back(position.x); m_y.push_back(position.y); m_z.push_back(position.z);
+    m_vx.push_back(velocity.x); m_vy.push_back(velocity.y); m_vz.push_back(velocity.z);
+    m_ax.push_back(0.0f); m_ay.push_back(0.0f); m_az.push_back(0.0f);
+    m_mass.push_back(mass);
+    m_accelerationValid = false;
+    return index;
+}
+
+void NBodySimulation::ParallelFor(size_t count, size_t grainSize,
+    const std::function<void(size_t, size_t)>& func) const {
+    if (m_pool)
+        m_pool->ParallelFor(count, grainSize, func);
+    else
+        func(0, count);
+}
+
+void NBodySimulation::GetPositions(glm::dvec3* positions) const {
+    ParallelFor(GetCount(), kGrainSize * 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            positions[i] = glm::dvec3(m_x[i], m_y[i], m_z[i]);
+    });
+}
+
+void NBodySimulation::Step(double dt) {
+    const size_t count = GetCount();
+    if (count == 0)
+        return;
+    if (!m_accelerationValid)
+        ComputeAccelerations();
+
+    // kick(dt / 2) + drift(dt)
+    const double halfDt = dt * 0.5;
+    ParallelFor(count, kGrainSize * 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            m_vx[i] += m_ax[i] * halfDt;
+            m_vy[i] += m_ay[i] * halfDt;
+            m_vz[i] += m_az[i] * halfDt;
+            m_x[i] += m_vx[i] * dt;
+            m_y[i] += m_vy[i] * dt;
+            m_z[i] += m_vz[i] * dt;
+        }
+    });
+
+    ComputeAccelerations();
+
+    // kick(dt / 2)
+    ParallelFor(count, kGrainSize * 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            m_vx[i] += m_ax[i] * halfDt;
+            m_vy[i] += m_ay[i] * halfDt;
+            m_vz[i] += m_az[i] * halfDt;
+        }
+    });
+}
+
+void NBodySimulation::BuildTree() {
+    const size_t count = GetCount();
+
+    // 전체를 감싸는 bounds, chunk별로 구한 뒤 합친다
+    size_t chunkCount = (count + kGrainSize - 1) / kGrainSize;
+    std::vector<glm::vec3> chunkMin(chunkCount), chunkMax(chunkCount);
+    ParallelFor(count, kGrainSize, [&](size_t begin, size_t end) {
+        glm::vec3 minPos = GetPosition(begin);
+        glm::vec3 maxPos = minPos;
+        for (size_t i = begin + 1; i < end; i++) {
+            minPos = glm::min(minPos, GetPosition(i));
+            maxPos = glm::max(maxPos, GetPosition(i));
+        }
+        chunkMin[begin / kGrainSize] = minPos;
+        chunkMax[begin / kGrainSize] = maxPos;
+    });
+    glm::vec3 minPos = chunkMin[0];
+    glm::vec3 maxPos = chunkMax[0];
+    for (size_t i = 1; i < chunkCount; i++) {
+        minPos = glm::min(minPos, chunkMin[i]);
+        maxPos = glm::max(maxPos, chunkMax[i]);
+    }
+    glm::vec3 extent = maxPos - minPos;
+    m_rootSize = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f)) * 1.0001f;
+    m_rootCenter = (minPos + maxPos) * 0.5f;
+
+    // morton code + index로 정렬, 천체는 step마다 조금씩만 움직이므로
+    // 이전 step의 정렬 순서로 key를 만들면 거의 정렬된 입력이 되어 정렬이 빨라진다
+    const bool reuseOrder = m_order.size() == count;
+    m_sortKey.resize(count);
+    const glm::vec3 origin = m_rootCenter - glm::vec3(m_rootSize * 0.5f);
+    const float cellScale = (float)(1 << kMortonBits) / m_rootSize;
+    const uint32_t maxCell = (1 << kMortonBits) - 1;
+    ParallelFor(count, kGrainSize, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            size_t i = reuseOrder ? m_order[k] : k;
+            glm::vec3 cell = (GetPosition(i) - origin) * cellScale;
+            uint32_t cx = std::min((uint32_t)std::max(cell.x, 0.0f), maxCell);
+            uint32_t cy = std::min((uint32_t)std::max(cell.y, 0.0f), maxCell);
+            uint32_t cz = std::min((uint32_t)std::max(cell.z, 0.0f), maxCell);
+            uint64_t code = SpreadBits(cx) << 2 | SpreadBits(cy) << 1 | SpreadBits(cz);
+            m_sortKey[k] = code << kIndexBits | (uint64_t)i;
+        }
+    });
+    std::sort(m_sortKey.begin(), m_sortKey.end());
+
+    // 정렬 순서로 모은 float 복사본, 순회할 때 메모리를 순서대로 읽게 된다
+    m_order.resize(count);
+    m_sortedX.resize(count);
+    m_sortedY.resize(count);
+    m_sortedZ.resize(count);
+    m_sortedMass.resize(count);
+    ParallelFor(count, kGrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint32_t index = (uint32_t)(m_sortKey[i] & kIndexMask);
+            m_order[i] = index;
+            m_sortedX[i] = (float)(m_x[index] - m_rootCenter.x);
+            m_sortedY[i] = (float)(m_y[index] - m_rootCenter.y);
+            m_sortedZ[i] = (float)(m_z[index] - m_rootCenter.z);
+            m_sortedMass[i] = m_mass[index];
+        }
+    });
+
+    // 노드는 morton 순서의 연속 범위이므로 code의 3 bit씩 이분 탐색으로 나눈다
+    m_nodes.clear();
+    m_nodes.reserve(count / kLeafSize * 2 + 1);
+    m_nodes.emplace_back();
+    m_groups.clear();
+    BuildNode(0, 0, (uint32_t)count, 0, false);
+}
+
+uint32_t NBodySimulation::BuildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end,
+    int level, bool inGroup) {
+    // 같은 morton cell에 kGroupSize보다 많이 겹친 leaf는 더 나눌 수 없으므로 그대로 group이 된다
+    // 모든 천체가 정확히 한 group에 들어가야 가속도가 계산된다
+    const bool leaf = end - begin <= kLeafSize || level == kMortonBits;
+    if (!inGroup && (end - begin <= kGroupSize || leaf)) {
+        m_groups.push_back(nodeIndex);
+        inGroup = true;
+    }
+
+    Node node {};
+    node.size = m_rootSize / (float)(1 << level);
+    node.begin = begin;
+    node.end = end;
+
+    if (leaf) {
+        // leaf: 담고 있는 천체의 질량 중심
+        double mass = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+        for (uint32_t i = begin; i < end; i++) {
+            mass += m_sortedMass[i];
+            cx += (double)m_sortedMass[i] * m_sortedX[i];
+            cy += (double)m_sortedMass[i] * m_sortedY[i];
+            cz += (double)m_sortedMass[i] * m_sortedZ[i];
+        }
+        double inverseMass = mass > 0.0 ? 1.0 / mass : 0.0;
+        node.mass = (float)mass;
+        node.center[0] = (float)(cx * inverseMass);
+        node.center[1] = (float)(cy * inverseMass);
+        node.center[2] = (float)(cz * inverseMass);
+        m_nodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    // 이 level의 octant bit로 범위를 나눈다, 빈 octant는 노드를 만들지 않는다
+    const int shift = kIndexBits + 3 * (kMortonBits - 1 - level);
+    uint32_t childBegin[8], childEnd[8];
+    uint32_t childCount = 0;
+    uint32_t rangeBegin = begin;
+    for (uint64_t octant = 0; octant < 8 && rangeBegin < end; octant++) {
+        auto rangeEnd = std::partition_point(
+            m_sortKey.begin() + rangeBegin, m_sortKey.begin() + end,
+            [shift, octant](uint64_t key) { return ((key >> shift) & 7) <= octant; });
+        uint32_t last = (uint32_t)(rangeEnd - m_sortKey.begin());
+        if (last > rangeBegin) {
+            childBegin[childCount] = rangeBegin;
+            childEnd[childCount] = last;
+            childCount++;
+        }
+        rangeBegin = last;
+    }
+
+    node.firstChild = (uint32_t)m_nodes.size();
+    node.childCount = childCount;
+    m_nodes.resize(m_nodes.size() + childCount);
+    double mass = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+    for (uint32_t i = 0; i < childCount; i++) {
+        // resize로 m_nodes가 옮겨질 수 있으므로 참조를 들고 있지 않는다
+        uint32_t child = BuildNode(node.firstChild + i, childBegin[i], childEnd[i],
+            level + 1, inGroup);
+        const Node& childNode = m_nodes[child];
+        mass += childNode.mass;
+        cx += (double)childNode.mass * childNode.center[0];
+        cy += (double)childNode.mass * childNode.center[1];
+        cz += (double)childNode.mass * childNode.center[2];
+    }
+    double inverseMass = mass > 0.0 ? 1.0 / mass : 0.0;
+    node.mass = (float)mass;
+    node.center[0] = (float)(cx * inverseMass);
+    node.center[1] = (float)(cy * inverseMass);
+    node.center[2] = (float)(cz * inverseMass);
+    m_nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+void NBodySimulation::ComputeAccelerations() {
+    auto buildBegin = std::chrono::steady_clock::now();
+    BuildTree();
+    m_stats.buildMs = ElapsedMs(buildBegin);
+    m_stats.nodeCount = m_nodes.size();
+    m_stats.groupCount = m_groups.size();
+
+    // group은 morton 순서이므로 한 chunk의 group들이 공간적으로 가까워 같은 노드를 읽는다
+    auto forceBegin = std::chrono::steady_clock::now();
+    std::atomic<size_t> interactionCount { 0 };
+    ParallelFor(m_groups.size(), 16, [&](size_t begin, size_t end) {
+        std::vector<float> interactions;
+        size_t chunkInteractions = 0;
+        for (size_t i = begin; i < end; i++) {
+            ComputeGroupAccelerations(m_groups[i], &interactions);
+            chunkInteractions += interactions.size() / 4;
+        }
+        interactionCount += chunkInteractions;
+    });
+    m_stats.interactionCount = interactionCount;
+    m_stats.forceMs = ElapsedMs(forceBegin);
+    m_accelerationValid = true;
+}
+
+void NBodySimulation::ComputeGroupAccelerations(uint32_t groupNode,
+    std::vector<float>* interactions) {
+    const Node& group = m_nodes[groupNode];
+    glm::vec3 minPos(m_sortedX[group.begin], m_sortedY[group.begin], m_sortedZ[group.begin]);
+    glm::vec3 maxPos = minPos;
+    for (uint32_t i = group.begin + 1; i < group.end; i++) {
+        glm::vec3 position(m_sortedX[i], m_sortedY[i], m_sortedZ[i]);
+        minPos = glm::min(minPos, position);
+        maxPos = glm::max(maxPos, position);
+    }
+
+    // group의 bounds에서 가장 가까운 점까지도 충분히 먼 노드만 한 점으로 보고,
+    // 그렇지 않은 leaf는 천체를 그대로 list에 넣는다 (x, y, z, mass 순서)
+    const float theta2 = m_theta * m_theta;
+    interactions->clear();
+    uint32_t stack[kMortonBits * 7 + 8];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        glm::vec3 center(node.center[0], node.center[1], node.center[2]);
+        glm::vec3 offset = glm::max(glm::max(minPos - center, center - maxPos), glm::vec3(0.0f));
+        float d2 = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+        if (node.size * node.size < theta2 * d2) {
+            interactions->insert(interactions->end(),
+                { node.center[0], node.center[1], node.center[2], node.mass });
+        }
+        else if (node.childCount == 0) {
+            for (uint32_t j = node.begin; j < node.end; j++) {
+                interactions->insert(interactions->end(),
+                    { m_sortedX[j], m_sortedY[j], m_sortedZ[j], m_sortedMass[j] });
+            }
+        }
+        else {
+            for (uint32_t c = 0; c < node.childCount; c++)
+                stack[top++] = node.firstChild + c;
+        }
+    }
+
+    // 자기 자신은 거리 0이라 softening 덕분에 더해지는 값이 0이다
+    const float softening2 = m_softening * m_softening;
+    const float* list = interactions->data();
+    const size_t listCount = interactions->size() / 4;
+    uint32_t i = group.begin;
+#ifdef NBODY_SIMULATION_SSE2
+    // group의 천체 4개를 한 번에, list의 원소 하나를 4 lane에 broadcast해서 더한다
+    const __m128 eps2 = _mm_set1_ps(softening2);
+    for (; i + 4 <= group.end; i += 4) {
+        const __m128 px = _mm_loadu_ps(&m_sortedX[i]);
+        const __m128 py = _mm_loadu_ps(&m_sortedY[i]);
+        const __m128 pz = _mm_loadu_ps(&m_sortedZ[i]);
+        __m128 ax = _mm_setzero_ps(), ay = _mm_setzero_ps(), az = _mm_setzero_ps();
+        for (size_t k = 0; k < listCount; k++) {
+            __m128 source = _mm_loadu_ps(list + k * 4);
+            __m128 dx = _mm_sub_ps(_mm_shuffle_ps(source, source, _MM_SHUFFLE(0, 0, 0, 0)), px);
+            __m128 dy = _mm_sub_ps(_mm_shuffle_ps(source, source, _MM_SHUFFLE(1, 1, 1, 1)), py);
+            __m128 dz = _mm_sub_ps(_mm_shuffle_ps(source, source, _MM_SHUFFLE(2, 2, 2, 2)), pz);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                _mm_add_ps(_mm_mul_ps(dz, dz), eps2));
+            __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(d2));
+            __m128 s = _mm_mul_ps(_mm_shuffle_ps(source, source, _MM_SHUFFLE(3, 3, 3, 3)),
+                _mm_mul_ps(inv, _mm_mul_ps(inv, inv)));
+            ax = _mm_add_ps(ax, _mm_mul_ps(dx, s));
+            ay = _mm_add_ps(ay, _mm_mul_ps(dy, s));
+            az = _mm_add_ps(az, _mm_mul_ps(dz, s));
+        }
+        float resultX[4], resultY[4], resultZ[4];
+        _mm_storeu_ps(resultX, ax);
+        _mm_storeu_ps(resultY, ay);
+        _mm_storeu_ps(resultZ, az);
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint32_t index = m_order[i + lane];
+            m_ax[index] = resultX[lane];
+            m_ay[index] = resultY[lane];
+            m_az[index] = resultZ[lane];
+        }
+    }
+#endif
+    // 4개 단위로 남는 나머지, 또는 SSE2가 없을 때 전체
+    for (; i < group.end; i++) {
+        const float px = m_sortedX[i];
+        const float py = m_sortedY[i];
+        const float pz = m_sortedZ[i];
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        for (size_t k = 0; k < listCount; k++) {
+            float dx = list[k * 4 + 0] - px;
+            float dy = list[k * 4 + 1] - py;
+            float dz = list[k * 4 + 2] - pz;
+            float d2 = dx * dx + dy * dy + dz * dz + softening2;
+            float inv = 1.0f / sqrtf(d2);
+            float s = list[k * 4 + 3] * inv * inv * inv;
+            ax += dx * s;
+            ay += dy * s;
+            az += dz * s;
+        }
+        uint32_t index = m_order[i];
+        m_ax[index] = ax;
+        m_ay[index] = ay;
+        m_az[index] = az;
+    }
+}
+
+void NBodySimulation::GetAccelerations(glm::vec3* accelerations) {
+    if (!m_accelerationValid)
+        ComputeAccelerations();
+    for (size_t i = 0; i < GetCount(); i++)
+        accelerations[i] = glm::vec3(m_ax[i], m_ay[i], m_az[i]);
+}
+
+void NBodySimulation::ComputeDirectAccelerations(glm::vec3* accelerations) const {
+    const size_t count = GetCount();
+    const double softening2 = (double)m_softening * m_softening;
+    ParallelFor(count, 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            double ax = 0.0, ay = 0.0, az = 0.0;
+            for (size_t j = 0; j < count; j++) {
+                double dx = m_x[j] - m_x[i];
+                double dy = m_y[j] - m_y[i];
+                double dz = m_z[j] - m_z[i];
+                double d2 = dx * dx + dy * dy + dz * dz + softening2;
+                double s = m_mass[j] / (d2 * sqrt(d2));
+                ax += dx * s;
+                ay += dy * s;
+                az += dz * s;
+            }
+            accelerations[i] = glm::vec3((float)ax, (float)ay, (float)az);
+        }
+    });
+}
+
+double NBodySimulation::ComputeEnergy() const {
+    const size_t count = GetCount();
+    double kinetic = 0.0, potential = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        kinetic += 0.5 * m_mass[i] * (m_vx[i] * m_vx[i] + m_vy[i] * m_vy[i] + m_vz[i] * m_vz[i]);
+        for (size_t j = i + 1; j < count; j++) {
+            double dx = m_x[j] - m_x[i];
+            double dy = m_y[j] - m_y[i];
+            double dz = m_z[j] - m_z[i];
+            double d2 = dx * dx + dy * dy + dz * dz + (double)m_softening * m_softening;
+            potential -= (double)m_mass[i] * m_mass[j] / sqrt(d2);
+        }
+    }
+    return kinetic + potential;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef __NBODY_SIMULATION_H__
+#define __NBODY_SIMULATION_H__
+
+#include "common.h"
+#include "thread_pool.h"
+
+// 중력 N-body 시뮬레이션, leapfrog(kick-drift-kick) 적분
+// 가속도는 Barnes-Hut octree로 O(N log N)에 근사한다
+// GL을 쓰지 않으므로 창 없이(headless) 돌릴 수 있다
+CLASS_PTR(NBodySimulation)
+class NBodySimulation {
+public:
+    struct Stats {
+        size_t nodeCount { 0 };
+        size_t groupCount { 0 };
+        size_t interactionCount { 0 };  // group마다 만든 interaction list 길이의 합
+        double buildMs { 0.0 };     // bounds, morton code, 정렬, octree
+        double forceMs { 0.0 };     // octree 순회
+    };
+
+    // pool이 nullptr이면 호출한 thread에서만 계산한다
+    static NBodySimulationUPtr Create(ThreadPool* pool = nullptr);
+
+    void Clear();
+    // mass는 G * m (G = 1), 단위는 scene 길이^3 / 일^2
+    size_t AddBody(const glm::dvec3& position, const glm::vec3& velocity, float mass);
+    size_t GetCount() const { return m_mass.size(); }
+
+    // dt(일)만큼 진행한다
+    void Step(double dt);
+
+    glm::vec3 GetPosition(size_t index) const {
+        return glm::vec3((float)m_x[index], (float)m_y[index], (float)m_z[index]);
+    }
+    void GetPositions(glm::dvec3* positions) const;
+    // 운동 에너지 + 위치 에너지, 모든 쌍을 직접 더하므로 검증용 (O(N^2))
+    double ComputeEnergy() const;
+    // 현재 위치에서 octree로 근사한 가속도, 아직 계산하지 않았으면 계산한다
+    void GetAccelerations(glm::vec3* accelerations);
+    // 모든 쌍을 직접 더한 가속도, GetAccelerations의 근사 오차 검증용 (O(N^2))
+    void ComputeDirectAccelerations(glm::vec3* accelerations) const;
+
+    // 노드 크기 / 거리 < theta 이면 노드를 한 점으로 본다, 작을수록 정확하고 느리다
+    void SetTheta(float theta) { m_theta = theta; }
+    float GetTheta() const { return m_theta; }
+    // 가까이 붙은 두 천체의 가속도가 발산하지 않도록 거리에 더하는 값
+    void SetSoftening(float softening) { m_softening = softening; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    NBodySimulation() {}
+    void ParallelFor(size_t count, size_t grainSize,
+        const std::function<void(size_t, size_t)>& func) const;
+    void BuildTree();
+    uint32_t BuildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, int level, bool inGroup);
+    void ComputeGroupAccelerations(uint32_t groupNode, std::vector<float>* interactions);
+    void ComputeAccelerations();
+
+    struct Node {
+        float center[3];        // 질량 중심
+        float mass;
+        float size;             // 노드 cell의 한 변 길이
+        uint32_t begin, end;    // morton 순서로 정렬된 천체 범위
+        uint32_t firstChild;    // 자식은 연속으로 저장된다
+        uint32_t childCount;    // 0이면 leaf
+    };
+
+    ThreadPool* m_pool { nullptr };
+    float m_theta { 0.5f };
+    float m_softening { 0.01f };
+    bool m_accelerationValid { false };
+    Stats m_stats;
+
+    // 천체 상태 (structure-of-arrays), 위치와 속도는 오래 적분해도 오차가 덜 쌓이도록 double
+    std::vector<double> m_x, m_y, m_z;
+    std::vector<double> m_vx, m_vy, m_vz;
+    std::vector<float> m_ax, m_ay, m_az;
+    std::vector<float> m_mass;
+
+    // octree, morton 순서로 정렬한 복사본을 root 중심 기준 float로 들고 있는다
+    std::vector<uint64_t> m_sortKey;        // 상위 42 bit: morton code, 하위 22 bit: 천체 index
+    std::vector<uint32_t> m_order;          // 정렬된 순서 -> 천체 index
+    std::vector<float> m_sortedX, m_sortedY, m_sortedZ, m_sortedMass;
+    std::vector<Node> m_nodes;
+    // 가까운 천체 묶음, 묶음마다 한 번만 순회해서 만든 interaction list를 모든 천체가 같이 쓴다
+    std::vector<uint32_t> m_groups;
+    glm::vec3 m_rootCenter { glm::vec3(0.0f) };
+    float m_rootSize { 1.0f };
+};
+
+#endif // __NBODY_SIMULATION_H__
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef __PAGE_FILE_FORMAT_H__
+#define __PAGE_FILE_FORMAT_H__
+
+#include <cstdint>
+
+// virtual texture page file (.vt), tools/page_file_builder가 만든다
+// header 뒤에 level 0부터 level마다 행(y), 열(x) 순서로 tile이 이어진다
+// tile은 border를 포함한 (tileSize + 2 * border)^2 개의 RGBA8 texel
+// level L의 tile 수는 max(tileCountX >> L, 1) x max(tileCountY >> L, 1)
+struct PageFileHeader {
+    uint32_t magic;             // PAGE_FILE_MAGIC
+    uint32_t version;
+    uint32_t tileCountX;        // level 0의 tile 수, 2의 거듭제곱
+    uint32_t tileCountY;
+    uint32_t tileSize;          // border를 뺀 tile 한 변의 texel 수
+    uint32_t border;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+const uint32_t PAGE_FILE_MAGIC = 0x46505456;    // "VTPF"
+const uint32_t PAGE_FILE_VERSION = 1;
+
+#endif // __PAGE_FILE_FORMAT_H__
\ No newline at end of file
@@ -1,4 +1,22 @@
 #include "program.h"
+#include <fstream>
+#include <filesystem>
+
+Program::UniformStats Program::s_uniformStats;
+Program::CacheStats Program::s_cacheStats;
+
+static const char* s_programCacheDir = "./cache/program";
+static const uint32_t s_programCacheMagic = 0x42505243;    // "CRPB"
+
+static uint32_t HashUniformName(const std::string& name) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c: name) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
 ProgramUPtr Program::Create(const std::vector<ShaderPtr>& shaders) {
     auto program = ProgramUPtr(new Program());
@@ -7,13 +25,74 @@ ProgramUPtr Program::Create(const std::vector<ShaderPtr>& shaders) {
     return std::move(program);
 }
 
+// glGetProgramBinary는 GL 4.1 또는 ARB_get_program_binary에서 지원
+static bool IsProgramBinarySupported() {
+    static int s_supported = -1;
+    if (s_supported < 0) {
+        int formatCount = 0;
+        if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        s_supported = formatCount > 0 ? 1 : 0;
+        if (!s_supported)
+            SPDLOG_INFO("program binary is not supported, shaders are compiled every launch");
+    }
+    return s_supported == 1;
+}
+
+// 전처리된 source와 driver 정보로 cache 파일 이름을 만든다
+// driver가 바뀌면 이름이 달라지므로 이전 binary는 자연히 무시된다
+static std::string GetProgramCacheFilename(const std::string& vsCode, const std::string& fsCode) {
+    // FNV-1a 64bit, 실행마다 값이 같아야 하므로 std::hash 대신 사용
+    uint64_t hash = 14695981039346656037ull;
+    auto hashString = [&hash](const char* text) {
+        for (; text && *text; text++) {
+            hash ^= (uint8_t)*text;
+            hash *= 1099511628211ull;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ull;
+    };
+    hashString(vsCode.c_str());
+    hashString(fsCode.c_str());
+    hashString((const char*)glGetString(GL_VENDOR));
+    hashString((const char*)glGetString(GL_RENDERER));
+    hashString((const char*)glGetString(GL_VERSION));
+    return fmt::format("{}/{:016x}.bin", s_programCacheDir, hash);
+}
+
 ProgramUPtr Program::Create(const std::string& vertShaderFilename,
-    const std::string& fragShaderFilename) {
-    ShaderPtr vs = Shader::CreateFromFile(vertShaderFilename, GL_VERTEX_SHADER);
-    ShaderPtr fs = Shader::CreateFromFile(fragShaderFilename, GL_FRAGMENT_SHADER);
+    const std::string& fragShaderFilename,
+    const std::vector<std::string>& defines) {
+    double startTime = glfwGetTime();
+    auto vsSource = Shader::LoadSource(vertShaderFilename, defines);
+    auto fsSource = Shader::LoadSource(fragShaderFilename, defines);
+    if (!vsSource || !fsSource)
+        return nullptr;
+
+    bool useCache = IsProgramBinarySupported();
+    std::string cacheFilename;
+    if (useCache) {
+        cacheFilename = GetProgramCacheFilename(vsSource->code, fsSource->code);
+        auto program = ProgramUPtr(new Program());
+        if (program->LoadBinary(cacheFilename)) {
+            s_cacheStats.hits++;
+            s_cacheStats.seconds += glfwGetTime() - startTime;
+            return std::move(program);
+        }
+    }
+
+    ShaderPtr vs = Shader::CreateFromFile(vertShaderFilename, GL_VERTEX_SHADER, defines);
+    ShaderPtr fs = Shader::CreateFromFile(fragShaderFilename, GL_FRAGMENT_SHADER, defines);
     if (!vs || !fs)
         return nullptr;
-    return std::move(Create({vs, fs}));
+    auto program = ProgramUPtr(new Program());
+    if (!program->Link({vs, fs}, useCache))
+        return nullptr;
+    if (useCache)
+        program->SaveBinary(cacheFilename);
+    s_cacheStats.misses++;
+    s_cacheStats.seconds += glfwGetTime() - startTime;
+    return std::move(program);
 }
 
 Program::~Program() {
@@ -22,11 +101,14 @@ Program::~Program() {
   }
 }
 
-bool Program::Link(const std::vector<ShaderPtr>& shaders) {
+bool Program::Link(const std::vector<ShaderPtr>& shaders, bool retrievable) {
     m_program = glCreateProgram();
 
     for (auto& shader: shaders)
         glAttachShader(m_program, shader->Get());
+    // link 전에 설정해야 driver가 binary를 보관한다
+    if (retrievable)
+        glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(m_program);
 
     int success = 0;
@@ -37,39 +119,219 @@ bool Program::Link(const std::vector<ShaderPtr>& shaders) {
         SPDLOG_ERROR("failed to link program: {}", infoLog);
         return false;
     }
+    ReflectUniforms();
     return true;
 }
 
+// cache 파일: magic, binary format, binary 길이, binary
+bool Program::LoadBinary(const std::string& filename) {
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin.is_open())
+        return false;
+    uint32_t header[3] = { 0, 0, 0 };
+    fin.read((char*)header, sizeof(header));
+    if (!fin || header[0] != s_programCacheMagic || header[2] == 0)
+        return false;
+    std::vector<char> binary(header[2]);
+    fin.read(binary.data(), binary.size());
+    if (!fin)
+        return false;
+
+    m_program = glCreateProgram();
+    glProgramBinary(m_program, (GLenum)header[1], binary.data(), (GLsizei)binary.size());
+    // driver update 등으로 binary가 거부되면 source에서 다시 만든다
+    int success = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    if (!success) {
+        SPDLOG_INFO("program binary rejected, rebuild from source: {}", filename);
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+    ReflectUniforms();
+    return true;
+}
+
+void Program::SaveBinary(const std::string& filename) const {
+    int length = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(m_program, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(s_programCacheDir, error);
+    std::ofstream fout(filename, std::ios::binary);
+    if (!fout.is_open()) {
+        SPDLOG_ERROR("failed to write program cache: {}", filename);
+        return;
+    }
+    uint32_t header[3] = { s_programCacheMagic, (uint32_t)format, (uint32_t)length };
+    fout.write((const char*)header, sizeof(header));
+    fout.write(binary.data(), length);
+}
+
+void Program::ReflectUniforms() {
+    int uniformCount = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    // load factor를 0.5 이하로 유지
+    size_t capacity = 16;
+    while (capacity < (size_t)uniformCount * 2)
+        capacity *= 2;
+    m_uniformSlots.clear();
+    m_uniformSlots.resize(capacity);
+    m_uniformCount = 0;
+
+    std::vector<char> nameBuffer(maxNameLength + 1);
+    for (int i = 0; i < uniformCount; i++) {
+        int length = 0;
+        int size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_program, i, (GLsizei)nameBuffer.size(),
+            &length, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+        auto location = glGetUniformLocation(m_program, name.c_str());
+        // uniform block 멤버는 location이 없다
+        if (location < 0)
+            continue;
+        AddUniform(name, location);
+
+        // 배열은 "name[0]"으로 보고되므로 "name"과 각 원소도 등록한다
+        auto bracket = name.find('[');
+        if (bracket == std::string::npos)
+            continue;
+        auto baseName = name.substr(0, bracket);
+        AddUniform(baseName, location);
+        for (int j = 1; j < size; j++) {
+            auto elementName = fmt::format("{}[{}]", baseName, j);
+            AddUniform(elementName, glGetUniformLocation(m_program, elementName.c_str()));
+        }
+    }
+}
+
+void Program::AddUniform(const std::string& name, int32_t location) {
+    if (location < 0)
+        return;
+    // 배열 원소 등록으로 load factor가 넘치면 table을 늘려서 다시 넣는다
+    if ((m_uniformCount + 1) * 2 > m_uniformSlots.size()) {
+        auto slots = std::move(m_uniformSlots);
+        m_uniformSlots.clear();
+        m_uniformSlots.resize(slots.size() * 2);
+        m_uniformCount = 0;
+        for (auto& slot: slots) {
+            if (!slot.name.empty())
+                AddUniform(slot.name, slot.location);
+        }
+    }
+
+    uint32_t hash = HashUniformName(name);
+    size_t mask = m_uniformSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        auto& slot = m_uniformSlots[i];
+        if (slot.name.empty()) {
+            slot.hash = hash;
+            slot.location = location;
+            slot.name = name;
+            m_uniformCount++;
+            return;
+        }
+        if (slot.hash == hash && slot.name == name)
+            return;
+    }
+}
+
+int32_t Program::FindUniform(const std::string& name) const {
+    if (m_uniformSlots.empty())
+        return -1;
+    uint32_t hash = HashUniformName(name);
+    size_t mask = m_uniformSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        auto& slot = m_uniformSlots[i];
+        if (slot.name.empty())
+            return -1;
+        if (slot.hash == hash && slot.name == name)
+            return slot.location;
+    }
+}
+
+UniformId Program::GetUniformId(const std::string& name) const {
+    return UniformId { FindUniform(name) };
+}
+
 void Program:: Use() const {
     glUseProgram(m_program);
 }
 
+// program에 선언되지 않은 block이면 false
+bool Program::BindUniformBlock(const std::string& blockName, uint32_t bindingPoint) const {
+    auto blockIndex = glGetUniformBlockIndex(m_program, blockName.c_str());
+    if (blockIndex == GL_INVALID_INDEX)
+        return false;
+    glUniformBlockBinding(m_program, blockIndex, bindingPoint);
+    return true;
+}
+
 void Program::SetUniform(const std::string& name, int value) const {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform1i(loc, value);
+    s_uniformStats.nameLookups++;
+    glUniform1i(FindUniform(name), value);
 }
 
 void Program::SetUniform(const std::string& name, const glm::mat4& value) const {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+    s_uniformStats.nameLookups++;
+    glUniformMatrix4fv(FindUniform(name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void Program::SetUniform(const std::string& name, float value) const {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform1f(loc, value);
+    s_uniformStats.nameLookups++;
+    glUniform1f(FindUniform(name), value);
 }
 
 void Program::SetUniform(const std::string& name, const glm::vec2& value) const {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform2fv(loc, 1, glm::value_ptr(value));
+    s_uniformStats.nameLookups++;
+    glUniform2fv(FindUniform(name), 1, glm::value_ptr(value));
 }
 
 void Program::SetUniform(const std::string& name, const glm::vec3& value) const {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform3fv(loc, 1, glm::value_ptr(value));
+    s_uniformStats.nameLookups++;
+    glUniform3fv(FindUniform(name), 1, glm::value_ptr(value));
 }
 
 void Program::SetUniform(const std::string& name, const glm::vec4& value) const {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform4fv(loc, 1, glm::value_ptr(value));
+    s_uniformStats.nameLookups++;
+    glUniform4fv(FindUniform(name), 1, glm::value_ptr(value));
+}
+
+void Program::SetUniform(UniformId id, int value) const {
+    s_uniformStats.idLookups++;
+    glUniform1i(id.location, value);
+}
+
+void Program::SetUniform(UniformId id, const glm::mat4& value) const {
+    s_uniformStats.idLookups++;
+    glUniformMatrix4fv(id.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Program::SetUniform(UniformId id, float value) const {
+    s_uniformStats.idLookups++;
+    glUniform1f(id.location, value);
+}
+
+void Program::SetUniform(UniformId id, const glm::vec2& value) const {
+    s_uniformStats.idLookups++;
+    glUniform2fv(id.location, 1, glm::value_ptr(value));
+}
+
+void Program::SetUniform(UniformId id, const glm::vec3& value) const {
+    s_uniformStats.idLookups++;
+    glUniform3fv(id.location, 1, glm::value_ptr(value));
+}
+
+void Program::SetUniform(UniformId id, const glm::vec4& value) const {
+    s_uniformStats.idLookups++;
+    glUniform4fv(id.location, 1, glm::value_ptr(value));
 }
\ No newline at end of file
@@ -4,28 +4,77 @@
 #include "common.h"
 #include "shader.h"
 
+// Link 시점에 미리 찾아둔 uniform location, 한 번 받아서 저장해두고 사용한다
+struct UniformId {
+    int32_t location { -1 };
+    bool IsValid() const { return location >= 0; }
+};
+
 CLASS_PTR(Program)
 class Program {
 public:
     static ProgramUPtr Create(const std::vector<ShaderPtr>& shaders);	
     static ProgramUPtr Create(const std::string& vertShaderFilename, 
-        const std::string& fragShaderFilename);
+        const std::string& fragShaderFilename,
+        const std::vector<std::string>& defines = {});
     
     ~Program();
     uint32_t Get() const { return m_program; }
     void Use() const;   
 
+    UniformId GetUniformId(const std::string& name) const;
+    bool BindUniformBlock(const std::string& blockName, uint32_t bindingPoint) const;
+
     void SetUniform(const std::string& name, int value) const;
     void SetUniform(const std::string& name, float value) const;
     void SetUniform(const std::string& name, const glm::vec2& value) const;
     void SetUniform(const std::string& name, const glm::vec3& value) const;
     void SetUniform(const std::string& name, const glm::vec4& value) const;
     void SetUniform(const std::string& name, const glm::mat4& value) const;
+
+    void SetUniform(UniformId id, int value) const;
+    void SetUniform(UniformId id, float value) const;
+    void SetUniform(UniformId id, const glm::vec2& value) const;
+    void SetUniform(UniformId id, const glm::vec3& value) const;
+    void SetUniform(UniformId id, const glm::vec4& value) const;
+    void SetUniform(UniformId id, const glm::mat4& value) const;
+
+    // glGetUniformLocation 호출 없이 처리된 SetUniform 횟수
+    struct UniformStats {
+        uint32_t nameLookups { 0 };     // 이름으로 cache를 조회한 횟수
+        uint32_t idLookups { 0 };       // UniformId로 바로 설정한 횟수
+    };
+    static const UniformStats& GetUniformStats() { return s_uniformStats; }
+    static void ResetUniformStats() { s_uniformStats = UniformStats(); }
+
+    // 파일로 만든 program의 binary cache 사용 현황
+    struct CacheStats {
+        uint32_t hits { 0 };            // cache된 binary를 그대로 load
+        uint32_t misses { 0 };          // source에서 compile / link
+        double seconds { 0.0 };         // program 생성에 걸린 시간 합
+    };
+    static const CacheStats& GetCacheStats() { return s_cacheStats; }
     
 private:
     Program() {}
-    bool Link(const std::vector<ShaderPtr>& shaders);
+    bool Link(const std::vector<ShaderPtr>& shaders, bool retrievable = false);
+    bool LoadBinary(const std::string& filename);
+    void SaveBinary(const std::string& filename) const;
+    void ReflectUniforms();
+    void AddUniform(const std::string& name, int32_t location);
+    int32_t FindUniform(const std::string& name) const;
     uint32_t m_program { 0 };
+
+    // active uniform 이름 -> location, open addressing (linear probing)
+    struct UniformSlot {
+        uint32_t hash { 0 };
+        int32_t location { -1 };
+        std::string name;
+    };
+    std::vector<UniformSlot> m_uniformSlots;
+    size_t m_uniformCount { 0 };
+    static UniformStats s_uniformStats;
+    static CacheStats s_cacheStats;
 };
 
 #endif // __PROGRAM_H__
\ No newline at end of file
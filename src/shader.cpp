@@ -1,8 +1,12 @@
 #include "shader.h"
+#include <sstream>
+#include <unordered_map>
+#include <algorithm>
 
-ShaderUPtr Shader::CreateFromFile(const std::string& filename, GLenum shaderType) {
+ShaderUPtr Shader::CreateFromFile(const std::string& filename, GLenum shaderType,
+    const std::vector<std::string>& defines) {
     auto shader = ShaderUPtr(new Shader());
-    if (!shader->LoadFile(filename, shaderType))
+    if (!shader->LoadFile(filename, shaderType, defines))
         return nullptr;
     return std::move(shader);
 }
@@ -13,12 +17,96 @@ Shader::~Shader(){
     }
 }
 
-bool Shader::LoadFile(const std::string& filename, GLenum shaderType) {
+static std::string GetDirectory(const std::string& filename) {
+    auto pos = filename.find_last_of("/\\");
+    return pos == std::string::npos ? std::string() : filename.substr(0, pos + 1);
+}
+
+// #include "path"를 재귀적으로 펼친다. path는 include하는 파일 기준 상대 경로이며
+// 같은 파일은 한 번만 포함된다 (#pragma once와 같은 동작)
+static bool ExpandIncludes(const std::string& filename, std::string& output,
+    std::vector<std::string>& files) {
+    if (std::find(files.begin(), files.end(), filename) != files.end())
+        return true;
     auto result = LoadTextFile(filename);
     if (!result.has_value())
         return false;
 
-    auto& code = result.value();
+    int sourceIndex = (int)files.size();
+    files.push_back(filename);
+    if (sourceIndex > 0)
+        output += fmt::format("#line 1 {}\n", sourceIndex);
+
+    std::istringstream stream(result.value());
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(stream, line)) {
+        lineNumber++;
+        auto first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line.compare(first, 8, "#include") != 0) {
+            output += line;
+            output += '\n';
+            continue;
+        }
+
+        auto open = line.find('"', first + 8);
+        auto close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos) {
+            SPDLOG_ERROR("invalid #include: \"{}\" ({}:{})", line, filename, lineNumber);
+            return false;
+        }
+        auto includeName = GetDirectory(filename) + line.substr(open + 1, close - open - 1);
+        if (!ExpandIncludes(includeName, output, files))
+            return false;
+        output += fmt::format("#line {} {}\n", lineNumber + 1, sourceIndex);
+    }
+    return true;
+}
+
+const Shader::Source* Shader::LoadSource(const std::string& filename,
+    const std::vector<std::string>& defines) {
+    // key 문자열 자체를 비교하므로 hash가 겹쳐도 다른 조합의 source를 돌려주지 않는다
+    static std::unordered_map<std::string, Source> s_sourceCache;
+
+    std::string key = filename;
+    for (auto& define: defines)
+        key += "\n" + define;
+    auto cached = s_sourceCache.find(key);
+    if (cached != s_sourceCache.end())
+        return &cached->second;
+
+    Source source;
+    if (!ExpandIncludes(filename, source.code, source.files))
+        return nullptr;
+
+    // defines는 "NAME VALUE" 형태이며 #version 바로 다음 줄에 #define으로 삽입된다
+    if (!defines.empty()) {
+        auto& code = source.code;
+        size_t insertPos = 0;
+        int versionLine = 0;
+        auto versionPos = code.find("#version");
+        if (versionPos != std::string::npos) {
+            versionLine = (int)std::count(code.begin(), code.begin() + versionPos, '\n') + 1;
+            insertPos = code.find('\n', versionPos);
+            insertPos = insertPos == std::string::npos ? code.length() : insertPos + 1;
+        }
+        std::string defineCode;
+        for (auto& define: defines)
+            defineCode += fmt::format("#define {}\n", define);
+        defineCode += fmt::format("#line {} 0\n", versionLine + 1);
+        code.insert(insertPos, defineCode);
+    }
+
+    return &s_sourceCache.emplace(std::move(key), std::move(source)).first->second;
+}
+
+bool Shader::LoadFile(const std::string& filename, GLenum shaderType,
+    const std::vector<std::string>& defines) {
+    auto source = LoadSource(filename, defines);
+    if (!source)
+        return false;
+
+    auto& code = source->code;
     const char* codePtr = code.c_str();
     int32_t codeLength = (int32_t)code.length();
 
@@ -34,6 +122,9 @@ bool Shader::LoadFile(const std::string& filename, GLenum shaderType) {
         char infoLog[1024];
         glGetShaderInfoLog(m_shader, 1024, nullptr, infoLog);
         SPDLOG_ERROR("failed to compile shader: \"{}\"", filename);
+        // error 메세지의 "source:line"에서 source 번호에 해당하는 파일
+        for (size_t i = 0; i < source->files.size(); i++)
+            SPDLOG_ERROR("source {}: {}", i, source->files[i]);
         SPDLOG_ERROR("reason: {}", infoLog);
         return false;
     }
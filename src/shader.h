@@ -6,13 +6,23 @@
 CLASS_PTR(Shader);
 class Shader {
 public:
-    static ShaderUPtr CreateFromFile(const std::string& filename, GLenum shaderType);
+    static ShaderUPtr CreateFromFile(const std::string& filename, GLenum shaderType,
+        const std::vector<std::string>& defines = {});
+
+    // #include를 펼치고 define을 삽입한 shader 코드, (파일, define) 조합마다 cache 된다
+    struct Source {
+        std::string code;
+        std::vector<std::string> files;     // #line의 source 번호 순서
+    };
+    static const Source* LoadSource(const std::string& filename,
+        const std::vector<std::string>& defines = {});
 
     ~Shader();
     uint32_t Get() const { return m_shader; }    
 private:
     Shader() {}
-    bool LoadFile(const std::string& filename, GLenum shaderType);
+    bool LoadFile(const std::string& filename, GLenum shaderType,
+        const std::vector<std::string>& defines);
     uint32_t m_shader { 0 };
 };
 
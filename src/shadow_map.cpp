@@ -2,7 +2,14 @@
 
 ShadowMapUPtr ShadowMap::Create(int width, int height) {
     auto shadowMap = ShadowMapUPtr(new ShadowMap());
-    if (!shadowMap->Init(width, height))
+    if (!shadowMap->Init(width, height, false))
+        return nullptr;
+    return std::move(shadowMap);
+}
+
+ShadowMapUPtr ShadowMap::CreateCube(int size) {
+    auto shadowMap = ShadowMapUPtr(new ShadowMap());
+    if (!shadowMap->Init(size, size, true))
         return nullptr;
     return std::move(shadowMap);
 }
@@ -17,17 +24,60 @@ void ShadowMap::Bind() const {
     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
 }
 
-bool ShadowMap::Init(int width, int height) {
-    glGenFramebuffers(1, &m_framebuffer);
+// cube shadow map은 face마다 depth attachment를 바꿔가며 그린다
+void ShadowMap::BindFace(int face) const {
     Bind();
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+        GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, m_shadowCubeMap->Get(), 0);
+}
 
-    m_shadowMap = Texture::Create(width, height, GL_DEPTH_COMPONENT, GL_FLOAT);
-    m_shadowMap->SetFilter(GL_NEAREST, GL_NEAREST); 	
-    m_shadowMap->SetWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
-    m_shadowMap->SetBorderColor(glm::vec4(1.0f));
+int ShadowMap::GetWidth() const {
+    return IsCube() ? m_shadowCubeMap->GetWidth() : m_shadowMap->GetWidth();
+}
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-        GL_TEXTURE_2D, m_shadowMap->Get(), 0);
+int ShadowMap::GetHeight() const {
+    return IsCube() ? m_shadowCubeMap->GetHeight() : m_shadowMap->GetHeight();
+}
+
+// depth texture가 차지하는 GPU 메모리 (byte)
+size_t ShadowMap::GetMemorySize() const {
+    size_t faceSize = (size_t)GetWidth() * (size_t)GetHeight() * sizeof(float);
+    return IsCube() ? faceSize * 6 : faceSize;
+}
+
+bool ShadowMap::Init(int width, int height, bool cube) {
+    m_cube = cube;
+    glGenFramebuffers(1, &m_framebuffer);
+    return SetResolution(width, height);
+}
+
+// 이전 depth texture를 버리고 새 해상도로 다시 할당한다
+bool ShadowMap::SetResolution(int width, int height) {
+    Bind();
+    if (m_cube) {
+        // samplerCubeShadow로 읽도록 depth 비교를 하드웨어에 맡긴다
+        m_shadowCubeMap = CubeTexture::Create(width, height, GL_DEPTH_COMPONENT24);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+            GL_TEXTURE_CUBE_MAP_POSITIVE_X, m_shadowCubeMap->Get(), 0);
+    }
+    else {
+        // sampler2DShadow의 linear filter는 2x2 texel 비교 결과를 보간해준다
+        m_shadowMap = Texture::Create(width, height, GL_DEPTH_COMPONENT24);
+        m_shadowMap->SetFilter(GL_LINEAR, GL_LINEAR); 	
+        m_shadowMap->SetWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
+        m_shadowMap->SetBorderColor(glm::vec4(1.0f));
+        m_shadowMap->SetCompareMode(GL_COMPARE_REF_TO_TEXTURE, GL_LEQUAL);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+            GL_TEXTURE_2D, m_shadowMap->Get(), 0);
+    }
+    return CheckFramebuffer();
+}
+
+bool ShadowMap::CheckFramebuffer() const {
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
     auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -7,18 +7,29 @@ CLASS_PTR(ShadowMap);
 class ShadowMap {
 public:
     static ShadowMapUPtr Create(int width, int height);
+    static ShadowMapUPtr CreateCube(int size);
     ~ShadowMap();
 
     const uint32_t Get() const { return m_framebuffer; }
     void Bind() const;
+    void BindFace(int face) const;
+    bool IsCube() const { return m_cube; }
+    int GetWidth() const;
+    int GetHeight() const;
+    size_t GetMemorySize() const;
+    bool SetResolution(int width, int height);
     const TexturePtr GetShadowMap() const { return m_shadowMap; }
+    const CubeTexturePtr GetShadowCubeMap() const { return m_shadowCubeMap; }
 
 private:
     ShadowMap() {}
-    bool Init(int width, int height);
+    bool Init(int width, int height, bool cube);
+    bool CheckFramebuffer() const;
 
     uint32_t m_framebuffer { 0 };
+    bool m_cube { false };
     TexturePtr m_shadowMap;
+    CubeTexturePtr m_shadowCubeMap;
 };
 
 #endif // __SHADOW_MAP_H__
\ No newline at end of file
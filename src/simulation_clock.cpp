@@ -0,0 +1,34 @@
+#include "simulation_clock.h"
+
+SimulationClockUPtr SimulationClock::Create(double stepSeconds) {
+    auto clock = SimulationClockUPtr(new SimulationClock());
+    clock->m_stepSeconds = stepSeconds;
+    return std::move(clock);
+}
+
+int SimulationClock::Advance(double wallTime) {
+    if (m_lastWallTime < 0.0) {
+        m_lastWallTime = wallTime;
+        return 0;
+    }
+    // 창을 끌거나 breakpoint에 멈춘 뒤 한꺼번에 따라잡지 않도록 한 프레임은 0.25초까지만
+    double frameTime = glm::min(wallTime - m_lastWallTime, 0.25);
+    m_lastWallTime = wallTime;
+    // 멈춘 동안은 accumulator도 그대로 두어 보간된 시간이 고정된다
+    if (m_paused)
+        return 0;
+
+    m_accumulator += frameTime;
+    int steps = 0;
+    while (m_accumulator >= m_stepSeconds) {
+        m_previousTime = m_time;
+        m_time += GetStepDays();
+        m_accumulator -= m_stepSeconds;
+        steps++;
+    }
+    return steps;
+}
+
+double SimulationClock::GetInterpolatedTime() const {
+    return m_previousTime + (m_time - m_previousTime) * GetAlpha();
+}
\ No newline at end of file
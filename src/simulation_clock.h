@@ -0,0 +1,43 @@
+#ifndef __SIMULATION_CLOCK_H__
+#define __SIMULATION_CLOCK_H__
+
+#include "common.h"
+
+// 시뮬레이션 시간(일 단위, double)을 wall clock과 분리해서 진행한다
+// 고정된 wall clock 간격(step)마다 step * timeScale 일씩 나아가고,
+// 렌더링은 마지막 두 step 사이를 보간한 시간으로 그린다
+CLASS_PTR(SimulationClock)
+class SimulationClock {
+public:
+    static SimulationClockUPtr Create(double stepSeconds = 1.0 / 120.0);
+
+    // 프레임마다 한 번 wall clock(초)을 넣는다, 이번 프레임에 진행한 step 수를 돌려준다
+    int Advance(double wallTime);
+
+    double GetTime() const { return m_time; }
+    double GetPreviousTime() const { return m_previousTime; }
+    // 이번 프레임을 그릴 시간, previous와 current step 사이
+    double GetInterpolatedTime() const;
+    double GetAlpha() const { return m_accumulator / m_stepSeconds; }
+    // step 하나가 진행하는 시뮬레이션 시간(일)
+    double GetStepDays() const { return m_stepSeconds * m_timeScale; }
+
+    // 실제 1초에 흐르는 일 수, 1.0이면 1초 = 1일
+    void SetTimeScale(double daysPerSecond) { m_timeScale = daysPerSecond; }
+    double GetTimeScale() const { return m_timeScale; }
+    void SetPaused(bool paused) { m_paused = paused; }
+    bool IsPaused() const { return m_paused; }
+
+private:
+    SimulationClock() {}
+    double m_stepSeconds { 1.0 / 120.0 };
+    double m_timeScale { 1.0 };
+    bool m_paused { false };
+
+    double m_lastWallTime { -1.0 };
+    double m_accumulator { 0.0 };   // 아직 step으로 소비하지 않은 wall clock 시간
+    double m_time { 0.0 };
+    double m_previousTime { 0.0 };
+};
+
+#endif // __SIMULATION_CLOCK_H__
\ No newline at end of file
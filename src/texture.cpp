@@ -1,17 +1,84 @@
 #include "texture.h"
+#include <algorithm>
 
-TextureUPtr Texture::Create(int width, int height, uint32_t format, uint32_t type) {
+// sized internal format에 대응하는 pixel format / type
+static bool GetTransferFormat(uint32_t internalFormat, uint32_t& format, uint32_t& type) {
+    switch (internalFormat) {
+        case GL_R8: format = GL_RED; type = GL_UNSIGNED_BYTE; return true;
+        case GL_RG8: format = GL_RG; type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGB8:
+        case GL_SRGB8: format = GL_RGB; type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGBA8:
+        case GL_SRGB8_ALPHA8: format = GL_RGBA; type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGB16F: format = GL_RGB; type = GL_FLOAT; return true;
+        case GL_RGBA16F:
+        case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; return true;
+        case GL_DEPTH_COMPONENT24: format = GL_DEPTH_COMPONENT; type = GL_UNSIGNED_INT; return true;
+        case GL_DEPTH_COMPONENT32F: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; return true;
+        case GL_DEPTH24_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; return true;
+        default: return false;
+    }
+}
+
+// 비압축 sized internal format의 pixel당 byte 수
+static size_t GetBytesPerPixel(uint32_t internalFormat) {
+    switch (internalFormat) {
+        case GL_R8: return 1;
+        case GL_RG8: return 2;
+        case GL_RGB8:
+        case GL_SRGB8: return 3;
+        case GL_RGB16F: return 6;
+        case GL_RGBA16F: return 8;
+        case GL_RGBA32F: return 16;
+        default: return 4;
+    }
+}
+
+// glTexStorage2D는 GL 4.2 또는 ARB_texture_storage
+static bool HasTextureStorage() {
+    return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_storage;
+}
+
+// 크기와 level 수가 고정된 storage를 할당한다
+// glTexStorage2D가 없으면 level마다 glTexImage2D로 같은 모양을 만든다
+static void AllocateStorage(uint32_t target, int levelCount, uint32_t internalFormat,
+    uint32_t format, uint32_t type, int width, int height) {
+    if (HasTextureStorage()) {
+        glTexStorage2D(target, levelCount, internalFormat, width, height);
+        return;
+    }
+    uint32_t faceCount = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    uint32_t faceTarget = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : target;
+    for (int level = 0; level < levelCount; level++) {
+        for (uint32_t face = 0; face < faceCount; face++) {
+            glTexImage2D(faceTarget + face, level, internalFormat,
+                std::max(width >> level, 1), std::max(height >> level, 1), 0,
+                format, type, nullptr);
+        }
+    }
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+}
+
+TextureUPtr Texture::Create(int width, int height, uint32_t internalFormat, int levelCount) {
     auto texture = TextureUPtr(new Texture());
     texture->CreateTexture();
-    texture->SetTextureFormat(width, height, format, type);
+    if (!texture->SetTextureFormat(width, height, internalFormat, levelCount))
+        return nullptr;
     texture->SetFilter(GL_LINEAR, GL_LINEAR);
     return std::move(texture);
 }
 
-TextureUPtr Texture::CreateFromImage(const Image* image) {
+TextureUPtr Texture::CreateFromImage(const Image* image, bool srgb) {
     auto texture = TextureUPtr(new Texture());
     texture->CreateTexture();
-    texture->SetTextureFromImage(image);
+    texture->SetTextureFromImage(image, srgb);
+    return std::move(texture);
+}
+
+TextureUPtr Texture::CreateFromCompressedImage(const CompressedImage* image, bool srgb) {
+    auto texture = TextureUPtr(new Texture());
+    texture->CreateTexture();
+    texture->SetTextureFromCompressedImage(image, srgb);
     return std::move(texture);
 }
 
@@ -39,16 +106,29 @@ void Texture::SetBorderColor(const glm::vec4& color) const {
     glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(color));
 }
 
-void Texture::SetTextureFormat(int width, int height, uint32_t format, uint32_t type) {
+// depth texture를 sampler2DShadow로 읽을 때 사용
+void Texture::SetCompareMode(uint32_t compareMode, uint32_t compareFunc) const {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, compareMode);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, compareFunc);
+}
+
+bool Texture::SetTextureFormat(int width, int height, uint32_t internalFormat, int levelCount) {
+    if (!GetTransferFormat(internalFormat, m_format, m_type)) {
+        SPDLOG_ERROR("unsupported texture internal format: 0x{:x}", internalFormat);
+        return false;
+    }
     m_width = width;
     m_height = height;
-    m_format = format;
-    m_type = type;
-
-    glTexImage2D(GL_TEXTURE_2D, 0, m_format,
-        m_width, m_height, 0,
-        m_format, m_type,
-        nullptr);
+    m_internalFormat = internalFormat;
+    m_levelCount = levelCount;
+    m_memorySize = 0;
+    for (int level = 0; level < m_levelCount; level++) {
+        m_memorySize += (size_t)std::max(m_width >> level, 1) *
+            std::max(m_height >> level, 1) * GetBytesPerPixel(m_internalFormat);
+    }
+    AllocateStorage(GL_TEXTURE_2D, m_levelCount, m_internalFormat,
+        m_format, m_type, m_width, m_height);
+    return true;
 }
 
 void Texture::CreateTexture() {
@@ -59,31 +139,88 @@ void Texture::CreateTexture() {
     SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
 }
 
-void Texture::SetTextureFromImage(const Image* image) {
-    GLenum format = GL_RGBA;
-    switch (image->GetChannelCount()) {
-        default: break;
-        case 1: format = GL_RED; break;
-        case 2: format = GL_RG; break;
-        case 3: format = GL_RGB; break;
+uint32_t Texture::GetImageInternalFormat(int channelCount, bool srgb) {
+    switch (channelCount) {
+        case 1: return GL_R8;
+        case 2: return GL_RG8;
+        case 3: return srgb ? GL_SRGB8 : GL_RGB8;
+        default: return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
     }
+}
+
+// 1x1까지의 전체 mip chain
+int Texture::GetMipLevelCount(int width, int height) {
+    int levelCount = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1)
+        levelCount++;
+    return levelCount;
+}
 
+// level 0을 다 채운 뒤 호출, mipmap filter로 바꿔준다
+void Texture::GenerateMipmap() const {
+    Bind();
+    glGenerateMipmap(GL_TEXTURE_2D);
+    SetFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+}
+
+void Texture::SetTextureFromImage(const Image* image, bool srgb) {
+    SetTextureFormat(image->GetWidth(), image->GetHeight(),
+        GetImageInternalFormat(image->GetChannelCount(), srgb),
+        GetMipLevelCount(image->GetWidth(), image->GetHeight()));
+
+    // RGB image는 줄 크기가 4의 배수가 아닐 수 있다
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+        m_width, m_height,
+        m_format, m_type,
+        image->GetData());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+// 압축된 mip level을 그대로 올린다, 파일에 들어있는 level까지만 사용
+void Texture::SetTextureFromCompressedImage(const CompressedImage* image, bool srgb) {
     m_width = image->GetWidth();
     m_height = image->GetHeight();
-    m_format = format;
+    m_levelCount = (int)image->GetLevelCount();
+    m_internalFormat = srgb ?
+        CompressedImage::GetSrgbFormat(image->GetFormat()) : image->GetFormat();
+    m_format = GL_RGBA;
     m_type = GL_UNSIGNED_BYTE;
- 
-    glTexImage2D(GL_TEXTURE_2D, 0, m_format,
-        m_width, m_height, 0,
-        format, m_type,
-        image->GetData());
+    m_memorySize = image->GetMemorySize();
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+    bool storage = HasTextureStorage();
+    if (storage)
+        glTexStorage2D(GL_TEXTURE_2D, m_levelCount, m_internalFormat, m_width, m_height);
+    for (int i = 0; i < m_levelCount; i++) {
+        auto& level = image->GetLevel(i);
+        if (storage) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0,
+                level.width, level.height, m_internalFormat,
+                (GLsizei)level.size, image->GetLevelData(i));
+        }
+        else {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, m_internalFormat,
+                level.width, level.height, 0,
+                (GLsizei)level.size, image->GetLevelData(i));
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levelCount - 1);
+    if (m_levelCount == 1)
+        SetFilter(GL_LINEAR, GL_LINEAR);
+}
+
+CubeTextureUPtr CubeTexture::Create(int width, int height, uint32_t internalFormat) {
+    auto texture = CubeTextureUPtr(new CubeTexture());
+    if (!texture->Init(width, height, internalFormat))
+        return nullptr;
+    return std::move(texture);
 }
 
-CubeTextureUPtr CubeTexture::CreateFromImages(const std::vector<Image*>& images) {
+CubeTextureUPtr CubeTexture::CreateFromImages(const std::vector<Image*>& images, bool srgb) {
     auto texture = CubeTextureUPtr(new CubeTexture());
-    if (!texture->InitFromImages(images))
+    if (!texture->InitFromImages(images, srgb))
         return nullptr;
     return std::move(texture);
 }
@@ -98,7 +235,15 @@ void CubeTexture::Bind() const {
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_texture);    
 }
 
-bool CubeTexture::InitFromImages(const std::vector<Image*>& images) {
+bool CubeTexture::Init(int width, int height, uint32_t internalFormat) {
+    if (!GetTransferFormat(internalFormat, m_format, m_type)) {
+        SPDLOG_ERROR("unsupported cube texture internal format: 0x{:x}", internalFormat);
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_internalFormat = internalFormat;
+
     glGenTextures(1, &m_texture);
     Bind();
 
@@ -108,21 +253,41 @@ bool CubeTexture::InitFromImages(const std::vector<Image*>& images) {
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    for (uint32_t i = 0; i < (uint32_t)images.size(); i++) {
-        auto image = images[i];
-        GLenum format = GL_RGBA;
-        switch (image->GetChannelCount()) {
-            default: break;
-            case 1: format = GL_RED; break;
-            case 2: format = GL_RG; break;
-            case 3: format = GL_RGB; break;
-        }
+    AllocateStorage(GL_TEXTURE_CUBE_MAP, 1, m_internalFormat,
+        m_format, m_type, m_width, m_height);
+    return true;
+}
 
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB,
-        image->GetWidth(), image->GetHeight(), 0,
-        format, GL_UNSIGNED_BYTE,
-        image->GetData());
+bool CubeTexture::InitFromImages(const std::vector<Image*>& images, bool srgb) {
+    if (images.size() != 6) {
+        SPDLOG_ERROR("cube texture needs 6 images: {}", images.size());
+        return false;
+    }
+    // 6면 모두 같은 크기 / channel 수여야 한다
+    auto first = images[0];
+    for (auto image: images) {
+        if (!image) {
+            SPDLOG_ERROR("cube texture face image is missing");
+            return false;
+        }
+        if (!first || image->GetWidth() != first->GetWidth() ||
+            image->GetHeight() != first->GetHeight() ||
+            image->GetChannelCount() != first->GetChannelCount()) {
+            SPDLOG_ERROR("cube texture faces must have the same size and channels");
+            return false;
+        }
     }
+    if (!Init(first->GetWidth(), first->GetHeight(),
+        Texture::GetImageInternalFormat(first->GetChannelCount(), srgb)))
+        return false;
 
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (uint32_t i = 0; i < (uint32_t)images.size(); i++) {
+        glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0,
+            m_width, m_height,
+            m_format, m_type,
+            images[i]->GetData());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     return true;
 }
\ No newline at end of file
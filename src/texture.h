@@ -2,13 +2,20 @@
 #define __TEXTURE_H__
 
 #include "image.h"
+#include "compressed_image.h"
 
+// texture는 sized internal format(GL_RGBA8, GL_SRGB8_ALPHA8, GL_DEPTH_COMPONENT24 ...)으로
+// 생성 시 크기와 mip level 수를 확정해서 할당한다 (가능하면 glTexStorage2D)
 CLASS_PTR(Texture)
 class Texture {
 public:
     static TextureUPtr Create(int width, int height,
-        uint32_t format, uint32_t type = GL_UNSIGNED_BYTE);
-    static TextureUPtr CreateFromImage(const Image* image);
+        uint32_t internalFormat, int levelCount = 1);
+    // srgb = true이면 색상 texture로 보고 sampling 시 linear로 변환되게 한다
+    static TextureUPtr CreateFromImage(const Image* image, bool srgb = false);
+    static TextureUPtr CreateFromCompressedImage(const CompressedImage* image, bool srgb = false);
+    static uint32_t GetImageInternalFormat(int channelCount, bool srgb);
+    static int GetMipLevelCount(int width, int height);
     ~Texture();
 
     const uint32_t Get() const { return m_texture; }
@@ -16,37 +23,61 @@ public:
     void SetFilter(uint32_t minFilter, uint32_t magFilter) const;
     void SetWrap(uint32_t sWrap, uint32_t tWrap) const;
     void SetBorderColor(const glm::vec4& color) const;
+    void SetCompareMode(uint32_t compareMode, uint32_t compareFunc) const;
+    void GenerateMipmap() const;
 
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
+    int GetLevelCount() const { return m_levelCount; }
+    uint32_t GetInternalFormat() const { return m_internalFormat; }
+    // glTexSubImage2D 등에 넘기는 pixel format / type
     uint32_t GetFormat() const { return m_format; }
     uint32_t GetType() const { return m_type; }
+    // 모든 mip level을 합친 GPU memory 크기(추정)
+    size_t GetMemorySize() const { return m_memorySize; }
 
 private:
     Texture() {}
     void CreateTexture();
-    void SetTextureFromImage(const Image* image);
-    void SetTextureFormat(int width, int height, uint32_t format, uint32_t type);
+    void SetTextureFromImage(const Image* image, bool srgb);
+    void SetTextureFromCompressedImage(const CompressedImage* image, bool srgb);
+    bool SetTextureFormat(int width, int height, uint32_t internalFormat, int levelCount);
 
     uint32_t m_texture { 0 };
     int m_width { 0 };
     int m_height { 0 };
+    int m_levelCount { 1 };
+    uint32_t m_internalFormat { GL_RGBA8 };
     uint32_t m_format { GL_RGBA };
     uint32_t m_type { GL_UNSIGNED_BYTE };   
+    size_t m_memorySize { 0 };
 };
 
 CLASS_PTR(CubeTexture)
 class CubeTexture {
 public:
-    static CubeTextureUPtr CreateFromImages(const std::vector<Image*>& images);
+    static CubeTextureUPtr Create(int width, int height, uint32_t internalFormat);
+    static CubeTextureUPtr CreateFromImages(const std::vector<Image*>& images, bool srgb = false);
     ~CubeTexture();
 
     const uint32_t Get() const { return m_texture; }
     void Bind() const;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    uint32_t GetInternalFormat() const { return m_internalFormat; }
+    uint32_t GetFormat() const { return m_format; }
+    uint32_t GetType() const { return m_type; }
 private:
     CubeTexture() {}
-    bool InitFromImages(const std::vector<Image*>& images);
+    bool Init(int width, int height, uint32_t internalFormat);
+    bool InitFromImages(const std::vector<Image*>& images, bool srgb);
     uint32_t m_texture { 0 };
+    int m_width { 0 };
+    int m_height { 0 };
+    uint32_t m_internalFormat { GL_RGBA8 };
+    uint32_t m_format { GL_RGBA };
+    uint32_t m_type { GL_UNSIGNED_BYTE };
 };
 
 #endif // __TEXTURE_H__
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "texture_cache.h"
+#include <filesystem>
+
+TextureCacheUPtr TextureCache::Create() {
+    return TextureCacheUPtr(new TextureCache());
+}
+
+// "./image/../image/earth.jpg"와 "image/earth.jpg"가 같은 key가 되도록 경로를 정규화한다
+std::string TextureCache::MakeKey(const std::string& filename, bool srgb, bool flipVertical) {
+    std::error_code error;
+    auto path = std::filesystem::weakly_canonical(filename, error);
+    auto name = error ? filename : path.generic_string();
+    return fmt::format("{}|{}|{}", name, srgb ? "srgb" : "linear", flipVertical ? "flip" : "noflip");
+}
+
+// 압축 texture는 decode 없이 바로 올린다, format을 지원하지 않으면 nullptr
+static TexturePtr LoadCompressedTexture(const std::string& filename, bool srgb) {
+    auto image = CompressedImage::Load(filename);
+    if (!image)
+        return nullptr;
+    auto format = srgb ? CompressedImage::GetSrgbFormat(image->GetFormat()) : image->GetFormat();
+    if (!CompressedImage::IsFormatSupported(format)) {
+        SPDLOG_WARN("compressed format 0x{:x} is not supported: {}",
+            image->GetFormat(), filename);
+        return nullptr;
+    }
+    SPDLOG_INFO("compressed texture: {} ({}x{}, {} levels, {} KB)", filename,
+        image->GetWidth(), image->GetHeight(), image->GetLevelCount(),
+        image->GetMemorySize() / 1024);
+    return Texture::CreateFromCompressedImage(image.get(), srgb);
+}
+
+TexturePtr TextureCache::Load(const std::string& filename, bool srgb, bool flipVertical) {
+    auto texture = Find(filename, srgb, flipVertical);
+    if (texture)
+        return texture;
+
+    auto extension = filename.substr(filename.find_last_of('.') + 1);
+    if (extension == "dds" || extension == "ktx") {
+        texture = LoadCompressedTexture(filename, srgb);
+    }
+    else {
+        auto image = Image::Load(filename, flipVertical);
+        if (image)
+            texture = Texture::CreateFromImage(image.get(), srgb);
+    }
+    if (texture)
+        Insert(filename, srgb, flipVertical, texture);
+    return texture;
+}
+
+TexturePtr TextureCache::Find(const std::string& filename, bool srgb, bool flipVertical) {
+    auto it = m_textures.find(MakeKey(filename, srgb, flipVertical));
+    TexturePtr texture = it != m_textures.end() ? it->second.lock() : nullptr;
+    if (!texture) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    m_stats.hits++;
+    m_stats.bytesSaved += texture->GetMemorySize();
+    return texture;
+}
+
+void TextureCache::Insert(const std::string& filename, bool srgb, bool flipVertical,
+    TexturePtr texture) {
+    m_textures[MakeKey(filename, srgb, flipVertical)] = texture;
+}
+
+// 해제된 texture의 항목을 정리하고 살아있는 texture 수를 돌려준다
+size_t TextureCache::GetLiveCount() {
+    for (auto it = m_textures.begin(); it != m_textures.end();) {
+        if (it->second.expired())
+            it = m_textures.erase(it);
+        else
+            ++it;
+    }
+    return m_textures.size();
+}
\ No newline at end of file
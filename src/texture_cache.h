@@ -0,0 +1,38 @@
+#ifndef __TEXTURE_CACHE_H__
+#define __TEXTURE_CACHE_H__
+
+#include "texture.h"
+#include <unordered_map>
+
+// 같은 파일을 같은 flag로 읽은 texture를 한 번만 decode / upload 하도록 공유한다
+// key는 정규화한 경로 + load flag, 값은 weak_ptr이라 아무도 쓰지 않는 texture는 그대로 해제된다
+CLASS_PTR(TextureCache)
+class TextureCache {
+public:
+    static TextureCacheUPtr Create();
+
+    struct Stats {
+        uint32_t hits { 0 };
+        uint32_t misses { 0 };
+        size_t bytesSaved { 0 };    // hit 덕분에 다시 올리지 않은 texture memory
+    };
+
+    // 살아있는 texture가 있으면 돌려주고 없으면 읽어서 등록한다
+    // .dds / .ktx는 압축 texture로, 나머지는 Image로 읽는다
+    TexturePtr Load(const std::string& filename, bool srgb, bool flipVertical = true);
+    // decode를 다른 thread에서 하는 경우: Find로 먼저 찾고 upload가 끝나면 Insert
+    TexturePtr Find(const std::string& filename, bool srgb, bool flipVertical = true);
+    void Insert(const std::string& filename, bool srgb, bool flipVertical, TexturePtr texture);
+
+    const Stats& GetStats() const { return m_stats; }
+    size_t GetLiveCount();
+
+private:
+    TextureCache() {}
+    static std::string MakeKey(const std::string& filename, bool srgb, bool flipVertical);
+
+    std::unordered_map<std::string, TextureWPtr> m_textures;
+    Stats m_stats;
+};
+
+#endif // __TEXTURE_CACHE_H__
\ No newline at end of file
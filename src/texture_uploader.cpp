@@ -0,0 +1,152 @@
+#include "texture_uploader.h"
+#include <algorithm>
+
+TextureUploaderUPtr TextureUploader::Create(size_t segmentSize, size_t segmentCount) {
+    auto uploader = TextureUploaderUPtr(new TextureUploader());
+    if (!uploader->Init(segmentSize, segmentCount))
+        return nullptr;
+    return std::move(uploader);
+}
+
+TextureUploader::~TextureUploader() {
+    for (auto fence: m_fences) {
+        if (fence)
+            glDeleteSync(fence);
+    }
+    if (m_buffer) {
+        if (m_mappedData) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+bool TextureUploader::Init(size_t segmentSize, size_t segmentCount) {
+    m_segmentSize = segmentSize;
+    m_fences.resize(segmentCount, nullptr);
+    size_t bufferSize = segmentSize * segmentCount;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    // GL 4.4 / ARB_buffer_storage가 있으면 한 번만 map 해두고 계속 쓴다
+    // 없으면 (GL 3.3) segment마다 unsynchronized map으로 대신한다
+    if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags);
+        m_mappedData = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags);
+    }
+    else {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if ((GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) && !m_mappedData) {
+        SPDLOG_ERROR("failed to map texture upload buffer");
+        return false;
+    }
+    SPDLOG_INFO("texture uploader: {} x {} KB segments ({})", segmentCount, segmentSize / 1024,
+        m_mappedData ? "persistent" : "unsynchronized map");
+    return true;
+}
+
+void TextureUploader::Upload(ImageUPtr image, bool srgb,
+    std::function<void(TexturePtr)> onComplete) {
+    if (!image)
+        return;
+    // 한 줄도 segment에 들어가지 않으면 나눠 올릴 수 없으므로 바로 올린다
+    size_t rowSize = (size_t)image->GetWidth() * image->GetChannelCount();
+    if (rowSize > m_segmentSize) {
+        SPDLOG_WARN("image row ({} bytes) exceeds upload segment, upload directly", rowSize);
+        onComplete(Texture::CreateFromImage(image.get(), srgb));
+        return;
+    }
+    Job job;
+    job.image = std::move(image);
+    job.srgb = srgb;
+    job.onComplete = std::move(onComplete);
+    m_jobs.push_back(std::move(job));
+}
+
+size_t TextureUploader::GetPendingBytes() const {
+    size_t bytes = 0;
+    for (auto& job: m_jobs) {
+        size_t rowSize = (size_t)job.image->GetWidth() * job.image->GetChannelCount();
+        bytes += rowSize * (job.image->GetHeight() - job.nextRow);
+    }
+    return bytes;
+}
+
+void TextureUploader::Update(size_t byteBudget) {
+    if (m_jobs.empty())
+        return;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    // RGB image는 줄 크기가 4의 배수가 아닐 수 있다
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    size_t uploadedBytes = 0;
+    while (!m_jobs.empty() && uploadedBytes < byteBudget) {
+        if (!UploadRows(byteBudget - uploadedBytes, uploadedBytes))
+            break;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// 첫 번째 job의 다음 줄들을 한 segment에 복사해서 올린다
+// 다음 segment를 GPU가 아직 읽고 있으면 기다리지 않고 false
+bool TextureUploader::UploadRows(size_t maxBytes, size_t& uploadedBytes) {
+    auto& job = m_jobs.front();
+    const Image* image = job.image.get();
+    if (!job.texture) {
+        job.texture = Texture::Create(image->GetWidth(), image->GetHeight(),
+            Texture::GetImageInternalFormat(image->GetChannelCount(), job.srgb),
+            Texture::GetMipLevelCount(image->GetWidth(), image->GetHeight()));
+    }
+
+    auto& fence = m_fences[m_segment];
+    if (fence) {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            return false;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    size_t rowSize = (size_t)image->GetWidth() * image->GetChannelCount();
+    size_t rowCount = std::min(m_segmentSize, std::max(maxBytes, rowSize)) / rowSize;
+    rowCount = std::min(rowCount, (size_t)(image->GetHeight() - job.nextRow));
+    size_t size = rowCount * rowSize;
+    size_t offset = m_segment * m_segmentSize;
+    const uint8_t* src = image->GetData() + job.nextRow * rowSize;
+
+    if (m_mappedData) {
+        memcpy(m_mappedData + offset, src, size);
+    }
+    else {
+        auto dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!dst)
+            return false;
+        memcpy(dst, src, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    job.texture->Bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.nextRow,
+        image->GetWidth(), (GLsizei)rowCount,
+        job.texture->GetFormat(), GL_UNSIGNED_BYTE, (const void*)offset);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_segment = (m_segment + 1) % m_fences.size();
+
+    job.nextRow += (int)rowCount;
+    uploadedBytes += size;
+    if (job.nextRow >= image->GetHeight()) {
+        job.texture->GenerateMipmap();
+        auto texture = std::move(job.texture);
+        auto onComplete = std::move(job.onComplete);
+        m_jobs.pop_front();
+        onComplete(texture);
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef __TEXTURE_UPLOADER_H__
+#define __TEXTURE_UPLOADER_H__
+
+#include "texture.h"
+#include <deque>
+#include <functional>
+
+// Image를 GL_PIXEL_UNPACK_BUFFER ring을 거쳐 여러 프레임에 나눠 texture로 올린다
+// ring은 segment 단위로 fence를 두어 GPU가 읽는 중인 영역은 덮어쓰지 않는다
+CLASS_PTR(TextureUploader)
+class TextureUploader {
+public:
+    static TextureUploaderUPtr Create(size_t segmentSize = 4 << 20, size_t segmentCount = 4);
+    ~TextureUploader();
+
+    // 업로드가 끝나면 mipmap까지 만든 texture를 onComplete로 넘겨준다
+    void Upload(ImageUPtr image, bool srgb, std::function<void(TexturePtr)> onComplete);
+    // 프레임마다 호출, 최대 byteBudget 만큼만 복사한다
+    void Update(size_t byteBudget);
+
+    size_t GetPendingCount() const { return m_jobs.size(); }
+    size_t GetPendingBytes() const;
+    bool IsPersistent() const { return m_mappedData != nullptr; }
+
+private:
+    TextureUploader() {}
+    bool Init(size_t segmentSize, size_t segmentCount);
+    bool UploadRows(size_t maxBytes, size_t& uploadedBytes);
+
+    struct Job {
+        ImageUPtr image;
+        TexturePtr texture;
+        int nextRow { 0 };
+        bool srgb { false };
+        std::function<void(TexturePtr)> onComplete;
+    };
+    std::deque<Job> m_jobs;
+
+    uint32_t m_buffer { 0 };
+    uint8_t* m_mappedData { nullptr };      // persistent mapping이 가능할 때만 사용
+    size_t m_segmentSize { 0 };
+    std::vector<GLsync> m_fences;
+    size_t m_segment { 0 };
+};
+
+#endif // __TEXTURE_UPLOADER_H__
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+
+ThreadPoolUPtr ThreadPool::Create(size_t threadCount) {
+    auto pool = ThreadPoolUPtr(new ThreadPool());
+    if (threadCount == 0) {
+        size_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+    pool->Init(threadCount);
+    return std::move(pool);
+}
+
+void ThreadPool::Init(size_t threadCount) {
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+        m_workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+// 남은 작업을 모두 처리한 뒤 worker를 종료한다
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker: m_workers)
+        worker.join();
+}
+
+void ThreadPool::Enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push(std::move(job));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty())
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+        job();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize,
+    const std::function<void(size_t, size_t)>& func) {
+    if (count == 0)
+        return;
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t chunkCount = (count + grainSize - 1) / grainSize;
+    if (chunkCount == 1 || m_workers.empty()) {
+        func(0, count);
+        return;
+    }
+
+    // 늦게 시작한 helper는 반환 이후에 state에 접근할 수 있으므로 shared_ptr로 공유한다
+    // 이미 chunk가 모두 나간 뒤라면 func는 건드리지 않고 바로 끝난다
+    struct State {
+        std::atomic<size_t> next { 0 };
+        std::atomic<size_t> remaining { 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<State>();
+    state->remaining = chunkCount;
+    const auto* body = &func;
+    auto run = [state, body, count, grainSize, chunkCount]() {
+        while (true) {
+            size_t chunk = state->next.fetch_add(1);
+            if (chunk >= chunkCount)
+                return;
+            size_t begin = chunk * grainSize;
+            (*body)(begin, std::min(begin + grainSize, count));
+            if (state->remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(m_workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helperCount; i++)
+        Enqueue(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->remaining.load() == 0; });
+}
\ No newline at end of file
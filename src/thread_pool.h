@@ -0,0 +1,54 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include "common.h"
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+
+// 고정된 수의 worker thread에서 작업을 실행한다
+// GL 호출은 main thread에서만 가능하므로 작업 안에서 GL 함수를 부르면 안 된다
+CLASS_PTR(ThreadPool)
+class ThreadPool {
+public:
+    // threadCount가 0이면 hardware thread 수 - 1 (최소 1)
+    static ThreadPoolUPtr Create(size_t threadCount = 0);
+    ~ThreadPool();
+
+    size_t GetThreadCount() const { return m_workers.size(); }
+
+    template <typename Func>
+    auto Submit(Func&& func) -> std::future<decltype(func())> {
+        using Result = decltype(func());
+        // std::function은 복사 가능해야 하므로 packaged_task를 shared_ptr로 감싼다
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        auto future = task->get_future();
+        Enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // [0, count)를 grainSize 단위 chunk로 나눠 worker와 호출한 thread가 함께 func(begin, end)를 실행한다
+    // chunk는 atomic counter로 하나씩 가져가므로 먼저 끝난 thread가 남은 chunk를 가져가고,
+    // 호출한 thread도 일을 하므로 worker가 다른 작업으로 바빠도 멈추지 않는다
+    void ParallelFor(size_t count, size_t grainSize,
+        const std::function<void(size_t, size_t)>& func);
+
+private:
+    ThreadPool() {}
+    void Init(size_t threadCount);
+    void Enqueue(std::function<void()> job);
+    void WorkerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop { false };
+};
+
+#endif // __THREAD_POOL_H__
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef __UNIFORM_BLOCK_H__
+#define __UNIFORM_BLOCK_H__
+
+#include "common.h"
+
+// uniform block binding point, 모든 program에서 같은 번호를 사용한다
+enum UniformBlockBinding : uint32_t {
+    PerFrameBlockBinding = 0,
+    LightsBlockBinding = 1,
+};
+
+// std140 layout, shader의 uniform block 선언과 멤버 순서가 같아야 한다
+// vec3 멤버는 16 byte로 정렬되므로 C++ 쪽에서는 vec4로 둔다
+struct PerFrameBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 viewPos;
+};
+
+struct LightsBlock {
+    glm::mat4 lightTransform;
+    glm::vec4 position;
+    glm::vec4 direction;
+    glm::vec4 attenuation;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    float shadowNearPlane;
+    float shadowFarPlane;
+    int32_t omniShadow;
+    int32_t padding;
+};
+
+#endif // __UNIFORM_BLOCK_H__
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "vertex_layout.h"
 
+uint32_t VertexLayout::s_boundVertexArray = 0;
+
 VertexLayoutUPtr VertexLayout::Create() {
     auto vertexLayout = VertexLayoutUPtr(new VertexLayout());
     vertexLayout->Init();
@@ -8,12 +10,18 @@ VertexLayoutUPtr VertexLayout::Create() {
 
 VertexLayout::~VertexLayout() {
     if (m_vertexArrayObject) {
+        if (s_boundVertexArray == m_vertexArrayObject)
+            s_boundVertexArray = 0;
         glDeleteVertexArrays(1, &m_vertexArrayObject);
     }
 }
 
+// geometry pool을 공유하는 mesh끼리는 같은 VAO이므로 다시 bind하지 않는다
 void VertexLayout::Bind() const {
+    if (s_boundVertexArray == m_vertexArrayObject)
+        return;
     glBindVertexArray(m_vertexArrayObject);
+    s_boundVertexArray = m_vertexArrayObject;
 }
 
 void VertexLayout::SetAttrib(
@@ -25,6 +33,14 @@ void VertexLayout::SetAttrib(
         type, normalized, stride, (const void*)offset);
 }
 
+void VertexLayout::SetAttribDivisor(uint32_t attribIndex, uint32_t divisor) const {
+    glVertexAttribDivisor(attribIndex, divisor);
+}
+
+void VertexLayout::DisableAttrib(int attribIndex) const {
+    glDisableVertexAttribArray(attribIndex);
+}
+
 void VertexLayout::Init() {
     glGenVertexArrays(1, &m_vertexArrayObject);
     Bind();
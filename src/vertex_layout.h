@@ -14,12 +14,14 @@ public:
     void SetAttrib(uint32_t attribIndex, int count,
         uint32_t type, bool normalized,
         size_t stride, uint64_t offset) const;
+    void SetAttribDivisor(uint32_t attribIndex, uint32_t divisor) const;
     void DisableAttrib(int attribIndex) const;
 
 private:
     VertexLayout() {}
     void Init();
     uint32_t m_vertexArrayObject { 0 };
+    static uint32_t s_boundVertexArray;
 };
 
 #endif // __VERTEX_LAYOUT_H__
\ No newline at end of file
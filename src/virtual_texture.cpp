@@ -0,0 +1,288 @@
+#include "virtual_texture.h"
+#include <cstring>
+
+VirtualTextureUPtr VirtualTexture::Create(const std::string& pageFilename, int atlasSlotCount) {
+    auto texture = VirtualTextureUPtr(new VirtualTexture());
+    if (!texture->Init(pageFilename, atlasSlotCount))
+        return nullptr;
+    return std::move(texture);
+}
+
+bool VirtualTexture::Init(const std::string& pageFilename, int atlasSlotCount) {
+    m_file = MappedFile::Open(pageFilename);
+    if (!m_file)
+        return false;
+    if (m_file->GetSize() < sizeof(PageFileHeader)) {
+        SPDLOG_ERROR("invalid page file: {}", pageFilename);
+        return false;
+    }
+    memcpy(&m_header, m_file->GetData(), sizeof(PageFileHeader));
+    if (m_header.magic != PAGE_FILE_MAGIC || m_header.version != PAGE_FILE_VERSION ||
+        m_header.levelCount == 0 || m_header.levelCount > 16) {
+        SPDLOG_ERROR("invalid page file: {}", pageFilename);
+        return false;
+    }
+
+    m_storedTileSize = (int)(m_header.tileSize + 2 * m_header.border);
+    m_tileDataSize = (size_t)m_storedTileSize * m_storedTileSize * 4;
+    int pageCount = 0;
+    for (int level = 0; level < (int)m_header.levelCount; level++) {
+        m_levelOffsets.push_back(pageCount);
+        pageCount += GetTileCountX(level) * GetTileCountY(level);
+    }
+    if (sizeof(PageFileHeader) + pageCount * m_tileDataSize > m_file->GetSize()) {
+        SPDLOG_ERROR("truncated page file: {}", pageFilename);
+        return false;
+    }
+
+    m_atlasSlotCount = atlasSlotCount;
+    int atlasSize = m_atlasSlotCount * m_storedTileSize;
+    m_atlas = Texture::Create(atlasSize, atlasSize, GL_SRGB8_ALPHA8);
+    // page table의 mip level 크기는 level별 tile 수와 같다
+    m_pageTable = Texture::Create(GetTileCountX(0), GetTileCountY(0), GL_RGBA8,
+        (int)m_header.levelCount);
+    if (!m_atlas || !m_pageTable)
+        return false;
+    m_pageTable->SetFilter(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
+
+    m_slots.resize(m_atlasSlotCount * m_atlasSlotCount);
+    m_pageSlots.resize(pageCount, -1);
+    m_pageRequestFrames.resize(pageCount, 0);
+    m_pageTableData.resize(m_header.levelCount);
+    for (int level = 0; level < (int)m_header.levelCount; level++)
+        m_pageTableData[level].resize(GetTileCountX(level) * GetTileCountY(level) * 4);
+
+    // 최상위 level은 항상 있어야 fallback이 된다
+    int topLevel = (int)m_header.levelCount - 1;
+    int topCount = GetTileCountX(topLevel) * GetTileCountY(topLevel);
+    if (topCount > (int)m_slots.size()) {
+        SPDLOG_ERROR("atlas is too small for page file: {}", pageFilename);
+        return false;
+    }
+    for (int i = 0; i < topCount; i++) {
+        m_slots[i].locked = true;
+        LoadPage(m_levelOffsets[topLevel] + i, i);
+    }
+    RebuildPageTable();
+
+    SPDLOG_INFO("virtual texture: {} ({}x{} texels, {} levels, {} pages, atlas {} slots)",
+        pageFilename, GetTileCountX(0) * m_header.tileSize, GetTileCountY(0) * m_header.tileSize,
+        m_header.levelCount, pageCount, m_slots.size());
+    return true;
+}
+
+void VirtualTexture::RequestPage(int level, int x, int y) {
+    if (level < 0 || level >= (int)m_header.levelCount)
+        return;
+    if (x >= GetTileCountX(level) || y >= GetTileCountY(level))
+        return;
+    // 상위 level tile도 같이 요청해서 fallback이 가까운 level을 가리키게 한다
+    for (; level < (int)m_header.levelCount; level++) {
+        int page = GetPageIndex(level, x, y);
+        if (m_pageRequestFrames[page] == m_frame)
+            return;
+        m_pageRequestFrames[page] = m_frame;
+        m_requests.push_back(page);
+        x = std::min(x / 2, GetTileCountX(level + 1) - 1);
+        y = std::min(y / 2, GetTileCountY(level + 1) - 1);
+    }
+}
+
+// 비어있는 slot, 없으면 이번 프레임에 쓰이지 않은 slot 중 가장 오래된 것
+int VirtualTexture::FindSlot() const {
+    int best = -1;
+    for (int i = 0; i < (int)m_slots.size(); i++) {
+        auto& slot = m_slots[i];
+        if (slot.locked)
+            continue;
+        if (slot.page < 0)
+            return i;
+        if (slot.lastUsed < m_frame && (best < 0 || slot.lastUsed < m_slots[best].lastUsed))
+            best = i;
+    }
+    return best;
+}
+
+void VirtualTexture::LoadPage(int page, int slot) {
+    auto& target = m_slots[slot];
+    if (target.page >= 0) {
+        m_pageSlots[target.page] = -1;
+        m_residentCount--;
+    }
+    target.page = page;
+    target.lastUsed = m_frame;
+    m_pageSlots[page] = slot;
+    m_residentCount++;
+
+    // mmap 된 tile을 바로 넘긴다, 실제 disk read는 여기서 page fault로 일어난다
+    const uint8_t* data = m_file->GetData() + sizeof(PageFileHeader) + page * m_tileDataSize;
+    m_atlas->Bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0,
+        (slot % m_atlasSlotCount) * m_storedTileSize,
+        (slot / m_atlasSlotCount) * m_storedTileSize,
+        m_storedTileSize, m_storedTileSize,
+        GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+void VirtualTexture::Update(int maxUploads) {
+    std::vector<int> missing;
+    for (int page: m_requests) {
+        int slot = m_pageSlots[page];
+        if (slot >= 0)
+            m_slots[slot].lastUsed = m_frame;
+        else
+            missing.push_back(page);
+    }
+    // 상위 level부터 올려야 빠르게 흐릿한 그림이라도 채워진다
+    std::sort(missing.begin(), missing.end(), [](int a, int b) { return a > b; });
+
+    int uploadCount = 0;
+    for (int page: missing) {
+        if (uploadCount >= maxUploads)
+            break;
+        int slot = FindSlot();
+        if (slot < 0)
+            break;
+        LoadPage(page, slot);
+        uploadCount++;
+    }
+    if (uploadCount > 0)
+        RebuildPageTable();
+
+    m_lastRequestCount = (int)m_requests.size();
+    m_lastUploadCount = uploadCount;
+    m_requests.clear();
+    m_frame++;
+}
+
+// 위 level부터 내려오며 없는 tile은 부모의 값을 물려받는다
+void VirtualTexture::RebuildPageTable() {
+    m_pageTable->Bind();
+    for (int level = (int)m_header.levelCount - 1; level >= 0; level--) {
+        int countX = GetTileCountX(level);
+        int countY = GetTileCountY(level);
+        auto& data = m_pageTableData[level];
+        for (int y = 0; y < countY; y++) {
+            for (int x = 0; x < countX; x++) {
+                uint8_t* entry = &data[(y * countX + x) * 4];
+                int slot = m_pageSlots[GetPageIndex(level, x, y)];
+                if (slot >= 0) {
+                    entry[0] = (uint8_t)(slot % m_atlasSlotCount);
+                    entry[1] = (uint8_t)(slot / m_atlasSlotCount);
+                    entry[2] = (uint8_t)level;
+                    entry[3] = 255;
+                    continue;
+                }
+                int parentCountX = GetTileCountX(level + 1);
+                int parentX = std::min(x / 2, parentCountX - 1);
+                int parentY = std::min(y / 2, GetTileCountY(level + 1) - 1);
+                memcpy(entry, &m_pageTableData[level + 1][(parentY * parentCountX + parentX) * 4], 4);
+            }
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, countX, countY,
+            GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+    }
+}
+
+VirtualTextureUniforms VirtualTextureUniforms::Find(const Program* program) {
+    VirtualTextureUniforms uniforms;
+    uniforms.pageTable = program->GetUniformId("vtPageTable");
+    uniforms.atlas = program->GetUniformId("vtAtlas");
+    uniforms.tileCount = program->GetUniformId("vtTileCount");
+    uniforms.tileSize = program->GetUniformId("vtTileSize");
+    uniforms.levelCount = program->GetUniformId("vtLevelCount");
+    uniforms.atlasSize = program->GetUniformId("vtAtlasSize");
+    return uniforms;
+}
+
+void VirtualTexture::SetToProgram(const Program* program, const VirtualTextureUniforms& uniforms,
+    int pageTableUnit, int atlasUnit) const {
+    glActiveTexture(GL_TEXTURE0 + pageTableUnit);
+    m_pageTable->Bind();
+    glActiveTexture(GL_TEXTURE0 + atlasUnit);
+    m_atlas->Bind();
+    glActiveTexture(GL_TEXTURE0);
+    program->SetUniform(uniforms.pageTable, pageTableUnit);
+    program->SetUniform(uniforms.atlas, atlasUnit);
+    program->SetUniform(uniforms.tileCount, glm::vec2(GetTileCountX(0), GetTileCountY(0)));
+    program->SetUniform(uniforms.tileSize, glm::vec2(m_header.tileSize, m_header.border));
+    program->SetUniform(uniforms.levelCount, (float)m_header.levelCount);
+    program->SetUniform(uniforms.atlasSize, (float)(m_atlasSlotCount * m_storedTileSize));
+}
+
+VirtualTextureFeedbackUPtr VirtualTextureFeedback::Create(int width, int height,
+    uint32_t depthFormat) {
+    auto feedback = VirtualTextureFeedbackUPtr(new VirtualTextureFeedback());
+    if (!feedback->Init(width, height, depthFormat))
+        return nullptr;
+    return std::move(feedback);
+}
+
+VirtualTextureFeedback::~VirtualTextureFeedback() {
+    if (m_fence)
+        glDeleteSync(m_fence);
+    if (m_buffer)
+        glDeleteBuffers(1, &m_buffer);
+}
+
+bool VirtualTextureFeedback::Init(int width, int height, uint32_t depthFormat) {
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    auto colorAttachment = Texture::Create(m_width, m_height, GL_RGBA8);
+    if (!colorAttachment)
+        return false;
+    colorAttachment->SetFilter(GL_NEAREST, GL_NEAREST);
+    m_framebuffer = Framebuffer::Create(std::move(colorAttachment), depthFormat);
+    if (!m_framebuffer)
+        return false;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, m_width * m_height * 4, nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void VirtualTextureFeedback::Begin() {
+    m_framebuffer->Bind();
+    glViewport(0, 0, m_width, m_height);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, m_clearColor);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTextureFeedback::End() {
+    // 이전 결과를 아직 읽지 않았으면 이번 프레임은 버린다
+    if (!m_fence) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+        glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    glClearColor(m_clearColor[0], m_clearColor[1], m_clearColor[2], m_clearColor[3]);
+    Framebuffer::BindToDefault();
+}
+
+void VirtualTextureFeedback::Resolve(const std::vector<VirtualTexture*>& textures) {
+    if (!m_fence || glClientWaitSync(m_fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        return;
+    glDeleteSync(m_fence);
+    m_fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+    auto data = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+        m_width * m_height * 4, GL_MAP_READ_BIT);
+    if (data) {
+        for (int i = 0; i < m_width * m_height; i++) {
+            const uint8_t* pixel = data + i * 4;
+            int id = (pixel[3] >> 4) - 1;
+            if (id < 0 || id >= (int)textures.size())
+                continue;
+            int x = pixel[0] | ((pixel[2] & 0x0f) << 8);
+            int y = pixel[1] | ((pixel[2] >> 4) << 8);
+            textures[id]->RequestPage(pixel[3] & 0x0f, x, y);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
\ No newline at end of file
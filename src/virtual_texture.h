@@ -0,0 +1,111 @@
+#ifndef __VIRTUAL_TEXTURE_H__
+#define __VIRTUAL_TEXTURE_H__
+
+#include "texture.h"
+#include "program.h"
+#include "framebuffer.h"
+#include "mapped_file.h"
+#include "page_file_format.h"
+#include <algorithm>
+
+// VirtualTexture::SetToProgram이 설정하는 uniform, program을 link한 뒤 한 번 찾아둔다
+struct VirtualTextureUniforms {
+    UniformId pageTable;
+    UniformId atlas;
+    UniformId tileCount;
+    UniformId tileSize;
+    UniformId levelCount;
+    UniformId atlasSize;
+    static VirtualTextureUniforms Find(const Program* program);
+};
+
+// page file(.vt)의 tile 중 화면에 보이는 것만 고정 크기 atlas에 올려두는 virtual texture
+// page table texture의 각 mip level이 tile마다 atlas 위치를 가리키고,
+// 아직 올라오지 않은 tile은 가장 가까운 상위 level tile을 가리킨다
+CLASS_PTR(VirtualTexture)
+class VirtualTexture {
+public:
+    // atlasSlotCount: atlas 한 변에 들어가는 tile 수
+    static VirtualTextureUPtr Create(const std::string& pageFilename, int atlasSlotCount = 16);
+
+    // feedback pass에서 보인 tile, 다음 Update에서 처리된다
+    void RequestPage(int level, int x, int y);
+    // 요청된 tile 중 없는 것을 최대 maxUploads 개 올리고 page table을 갱신한다
+    void Update(int maxUploads);
+    void SetToProgram(const Program* program, const VirtualTextureUniforms& uniforms,
+        int pageTableUnit, int atlasUnit) const;
+
+    int GetLevelCount() const { return (int)m_header.levelCount; }
+    int GetResidentCount() const { return m_residentCount; }
+    int GetSlotCount() const { return (int)m_slots.size(); }
+    int GetRequestCount() const { return m_lastRequestCount; }
+    int GetUploadCount() const { return m_lastUploadCount; }
+
+private:
+    VirtualTexture() {}
+    bool Init(const std::string& pageFilename, int atlasSlotCount);
+    int GetPageIndex(int level, int x, int y) const {
+        return m_levelOffsets[level] + y * GetTileCountX(level) + x;
+    }
+    int GetTileCountX(int level) const { return std::max((int)m_header.tileCountX >> level, 1); }
+    int GetTileCountY(int level) const { return std::max((int)m_header.tileCountY >> level, 1); }
+    int FindSlot() const;
+    void LoadPage(int page, int slot);
+    void RebuildPageTable();
+
+    MappedFileUPtr m_file;
+    PageFileHeader m_header;
+    size_t m_tileDataSize { 0 };
+    int m_storedTileSize { 0 };
+    std::vector<int> m_levelOffsets;
+
+    TexturePtr m_atlas;
+    TexturePtr m_pageTable;
+    int m_atlasSlotCount { 0 };
+
+    // atlas slot, 최상위 level tile은 항상 남겨둔다
+    struct Slot {
+        int page { -1 };
+        uint64_t lastUsed { 0 };
+        bool locked { false };
+    };
+    std::vector<Slot> m_slots;
+    std::vector<int> m_pageSlots;               // page -> slot, 없으면 -1
+    std::vector<uint64_t> m_pageRequestFrames;  // 같은 프레임 중복 요청 제거
+    std::vector<int> m_requests;
+    std::vector<std::vector<uint8_t>> m_pageTableData;
+    uint64_t m_frame { 1 };
+    int m_residentCount { 0 };
+    int m_lastRequestCount { 0 };
+    int m_lastUploadCount { 0 };
+};
+
+// 낮은 해상도로 보이는 tile을 기록하고 한 프레임 늦게 읽어온다 (GPU stall 방지)
+// 각 pixel: R, G = tile x, y 하위 8bit, B = x, y 상위 4bit, A = level | (texture id + 1) << 4
+CLASS_PTR(VirtualTextureFeedback)
+class VirtualTextureFeedback {
+public:
+    // depthFormat: main pass와 같은 형식, reversed-Z이면 GL_DEPTH32F_STENCIL8
+    static VirtualTextureFeedbackUPtr Create(int width, int height,
+        uint32_t depthFormat = GL_DEPTH24_STENCIL8);
+    ~VirtualTextureFeedback();
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    void Begin();
+    void End();
+    // 이전 End에서 읽은 결과를 각 virtual texture에 요청으로 전달
+    void Resolve(const std::vector<VirtualTexture*>& textures);
+
+private:
+    VirtualTextureFeedback() {}
+    bool Init(int width, int height, uint32_t depthFormat);
+    FramebufferUPtr m_framebuffer;
+    uint32_t m_buffer { 0 };
+    GLsync m_fence { nullptr };
+    int m_width { 0 };
+    int m_height { 0 };
+    float m_clearColor[4];
+};
+
+#endif // __VIRTUAL_TEXTURE_H__
\ No newline at end of file
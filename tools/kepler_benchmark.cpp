@@ -0,0 +1,72 @@
+// KeplerOrbitTable::Propagate의 scalar / SIMD 처리량(bodies/ms) 비교
+// usage: kepler_benchmark [body count = 1048576] [repeat = 20]
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "kepler_orbit.h"
+
+template <typename Func>
+static double MeasureBest(int repeat, Func func) {
+    double best = 1e30;
+    for (int i = 0; i < repeat; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        func(i);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : (size_t)1 << 20;
+    int repeat = argc > 2 ? atoi(argv[2]) : 20;
+    if (count == 0 || repeat <= 0) {
+        printf("usage: %s [body count] [repeat]\n", argv[0]);
+        return 1;
+    }
+
+    // 소행성대와 비슷한 분포의 궤도 요소
+    auto orbits = KeplerOrbitTable::Create();
+    orbits->Reserve(count);
+    std::mt19937 generator(2021);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (size_t i = 0; i < count; i++) {
+        KeplerElements elements;
+        elements.semiMajorAxis = glm::mix(14.0f, 17.0f, unit(generator));
+        elements.eccentricity = unit(generator) * 0.3f;
+        elements.inclination = glm::radians(unit(generator) * 20.0f);
+        elements.ascendingNode = unit(generator) * glm::two_pi<float>();
+        elements.argumentOfPeriapsis = unit(generator) * glm::two_pi<float>();
+        elements.meanAnomaly = unit(generator) * glm::two_pi<float>();
+        elements.period = 365.0 * pow(elements.semiMajorAxis / 9.0, 1.5);
+        orbits->AddOrbit(elements);
+    }
+
+    std::vector<float> x(count), y(count), z(count);
+    std::vector<float> sx(count), sy(count), sz(count);
+    double scalarMs = MeasureBest(repeat, [&](int i) {
+        orbits->PropagateScalar(i * 0.5, sx.data(), sy.data(), sz.data());
+    });
+    double simdMs = MeasureBest(repeat, [&](int i) {
+        orbits->Propagate(i * 0.5, x.data(), y.data(), z.data());
+    });
+
+    // 마지막 호출은 같은 time이므로 두 결과를 비교할 수 있다
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        maxError = std::max(maxError, std::max(fabsf(x[i] - sx[i]),
+            std::max(fabsf(y[i] - sy[i]), fabsf(z[i] - sz[i]))));
+    }
+
+    printf("bodies: %zu, repeat: %d (best of)\n", count, repeat);
+    printf("scalar: %8.3f ms, %10.1f bodies/ms\n", scalarMs, count / scalarMs);
+    printf("%-6s: %8.3f ms, %10.1f bodies/ms (x%.2f)\n",
+        KeplerOrbitTable::IsSimdSupported() ? "sse2" : "none",
+        simdMs, count / simdMs, scalarMs / simdMs);
+    printf("max position error: %g\n", maxError);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+// NBodySimulation을 창 없이 돌려 가속도 오차, step 시간과 에너지 보존을 확인한다
+// usage: nbody_benchmark [body count = 100000] [steps = 20] [threads = 0 (hardware - 1)]
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include "nbody_simulation.h"
+
+// 태양 질량은 반경 9.0에서 공전주기 365일이 되도록 맞춘다 (G * m)
+static const float kSunMass = glm::two_pi<float>() * glm::two_pi<float>() * 729.0f / (365.0f * 365.0f);
+
+// 태양 하나와 그 주위를 원 궤도로 도는 얇은 원반
+static void AddDisk(NBodySimulation* simulation, size_t count, uint32_t seed) {
+    simulation->AddBody(glm::dvec3(0.0), glm::vec3(0.0f), kSunMass);
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (size_t i = 1; i < count; i++) {
+        float radius = 5.0f + 12.0f * unit(generator);
+        float angle = unit(generator) * glm::two_pi<float>();
+        float height = (unit(generator) - 0.5f) * 0.2f;
+        float speed = sqrtf(kSunMass / radius);
+        simulation->AddBody(
+            glm::dvec3(cosf(angle) * radius, height, sinf(angle) * radius),
+            glm::vec3(-sinf(angle) * speed, 0.0f, cosf(angle) * speed),
+            kSunMass * 1e-9f);
+    }
+}
+
+// 작은 theta에서 octree 가속도가 모든 쌍을 직접 더한 값과 맞는지 확인한다
+// 한 점에 group 크기보다 많이 겹친 천체도 넣어서 나눌 수 없는 leaf도 가속도를 받는지 본다
+static bool CheckAccelerations(ThreadPool* pool) {
+    const float theta = 0.1f;
+    const float maxError = 2e-3f;
+    auto simulation = NBodySimulation::Create(pool);
+    AddDisk(simulation.get(), 4000, 7);
+    for (int i = 0; i < 200; i++)
+        simulation->AddBody(glm::dvec3(9.0, 0.0, 0.0), glm::vec3(0.0f), kSunMass * 1e-9f);
+    simulation->SetTheta(theta);
+
+    const size_t count = simulation->GetCount();
+    std::vector<glm::vec3> approximate(count), direct(count);
+    simulation->GetAccelerations(approximate.data());
+    simulation->ComputeDirectAccelerations(direct.data());
+    double worst = 0.0;
+    size_t worstIndex = 0;
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 diff = approximate[i] - direct[i];
+        double error = sqrt(glm::dot(diff, diff) / std::max(glm::dot(direct[i], direct[i]), 1e-30f));
+        if (error > worst) {
+            worst = error;
+            worstIndex = i;
+        }
+    }
+    printf("acceleration check (theta %.2f, %zu bodies): max relative error %g (body %zu)\n",
+        theta, count, worst, worstIndex);
+    return worst <= maxError;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 100000;
+    int steps = argc > 2 ? atoi(argv[2]) : 20;
+    size_t threads = argc > 3 ? (size_t)strtoull(argv[3], nullptr, 10) : 0;
+    if (count < 2 || steps <= 0) {
+        printf("usage: %s [body count] [steps] [threads]\n", argv[0]);
+        return 1;
+    }
+
+    auto pool = ThreadPool::Create(threads);
+    if (!CheckAccelerations(pool.get())) {
+        printf("acceleration check failed\n");
+        return 1;
+    }
+    auto simulation = NBodySimulation::Create(pool.get());
+    AddDisk(simulation.get(), count, 2021);
+
+    // 에너지는 O(N^2)이므로 작은 경우에만 계산한다
+    const bool checkEnergy = count <= 20000;
+    double initialEnergy = checkEnergy ? simulation->ComputeEnergy() : 0.0;
+
+    const double dt = 0.5;
+    double totalMs = 0.0, buildMs = 0.0, forceMs = 0.0;
+    for (int i = 0; i < steps; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        simulation->Step(dt);
+        totalMs += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - begin).count();
+        buildMs += simulation->GetStats().buildMs;
+        forceMs += simulation->GetStats().forceMs;
+    }
+
+    printf("bodies: %zu, threads: %zu + caller, steps: %d, dt: %g days\n",
+        count, pool->GetThreadCount(), steps, dt);
+    auto& stats = simulation->GetStats();
+    printf("step: %8.3f ms (tree %.3f ms, force %.3f ms)\n",
+        totalMs / steps, buildMs / steps, forceMs / steps);
+    printf("nodes: %zu, groups: %zu, interactions/group: %.1f\n", stats.nodeCount,
+        stats.groupCount, (double)stats.interactionCount / std::max<size_t>(stats.groupCount, 1));
+    if (checkEnergy) {
+        double energy = simulation->ComputeEnergy();
+        printf("relative energy drift: %g\n", fabs((energy - initialEnergy) / initialEnergy));
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+// 큰 planet texture를 virtual texture page file(.vt)로 나누는 offline 도구
+// usage: page_file_builder <input> <output.vt> [tileSize] [border]
+// level 0의 tile 수가 2의 거듭제곱이 되도록 필요하면 resample 한 뒤 mip level마다 tile로 저장한다
+// OpenGL 좌하단 원점에 맞춰 상하를 뒤집어 저장한다
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "../src/page_file_format.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+struct Surface {
+    int width { 0 };
+    int height { 0 };
+    std::vector<uint8_t> rgba;
+};
+
+static int NextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+// bilinear resample, 정확히 절반으로 줄이면 2x2 box filter와 같다
+// 가로는 경도이므로 wrap, 세로는 clamp
+static Surface Resample(const Surface& src, int width, int height) {
+    Surface dst;
+    dst.width = width;
+    dst.height = height;
+    dst.rgba.resize((size_t)width * height * 4);
+    float scaleX = (float)src.width / width;
+    float scaleY = (float)src.height / height;
+    for (int y = 0; y < height; y++) {
+        float sy = std::min(std::max((y + 0.5f) * scaleY - 0.5f, 0.0f), (float)(src.height - 1));
+        int y0 = (int)sy;
+        int y1 = std::min(y0 + 1, src.height - 1);
+        float fy = sy - y0;
+        for (int x = 0; x < width; x++) {
+            float sx = (x + 0.5f) * scaleX - 0.5f;
+            int x0 = (int)floorf(sx);
+            float fx = sx - x0;
+            int x1 = (x0 + 1) % src.width;
+            x0 = (x0 + src.width) % src.width;
+            for (int k = 0; k < 4; k++) {
+                float a = src.rgba[((size_t)y0 * src.width + x0) * 4 + k];
+                float b = src.rgba[((size_t)y0 * src.width + x1) * 4 + k];
+                float c = src.rgba[((size_t)y1 * src.width + x0) * 4 + k];
+                float d = src.rgba[((size_t)y1 * src.width + x1) * 4 + k];
+                float value = (a * (1 - fx) + b * fx) * (1 - fy) + (c * (1 - fx) + d * fx) * fy;
+                dst.rgba[((size_t)y * width + x) * 4 + k] = (uint8_t)(value + 0.5f);
+            }
+        }
+    }
+    return dst;
+}
+
+// border를 포함한 tile 하나를 잘라낸다
+static void CopyTile(const Surface& surface, int tileX, int tileY, int tileSize, int border,
+    std::vector<uint8_t>& tile) {
+    int storedSize = tileSize + 2 * border;
+    for (int j = 0; j < storedSize; j++) {
+        int y = std::min(std::max(tileY * tileSize + j - border, 0), surface.height - 1);
+        for (int i = 0; i < storedSize; i++) {
+            int x = (tileX * tileSize + i - border + surface.width) % surface.width;
+            memcpy(&tile[((size_t)j * storedSize + i) * 4],
+                &surface.rgba[((size_t)y * surface.width + x) * 4], 4);
+        }
+    }
+}
+
+int main(int argc, const char** argv) {
+    if (argc < 3) {
+        printf("usage: %s <input> <output.vt> [tileSize] [border]\n", argv[0]);
+        return 1;
+    }
+    int tileSize = argc > 3 ? atoi(argv[3]) : 128;
+    int border = argc > 4 ? atoi(argv[4]) : 4;
+    if (tileSize <= 0 || border < 0 || border * 2 >= tileSize) {
+        printf("invalid tile size / border: %d / %d\n", tileSize, border);
+        return 1;
+    }
+
+    Surface surface;
+    int channelCount = 0;
+    stbi_set_flip_vertically_on_load(true);
+    uint8_t* data = stbi_load(argv[1], &surface.width, &surface.height, &channelCount, 4);
+    if (!data) {
+        printf("failed to load image: %s\n", argv[1]);
+        return 1;
+    }
+    surface.rgba.assign(data, data + (size_t)surface.width * surface.height * 4);
+    stbi_image_free(data);
+
+    PageFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PAGE_FILE_MAGIC;
+    header.version = PAGE_FILE_VERSION;
+    header.tileCountX = NextPowerOfTwo((surface.width + tileSize - 1) / tileSize);
+    header.tileCountY = NextPowerOfTwo((surface.height + tileSize - 1) / tileSize);
+    header.tileSize = tileSize;
+    header.border = border;
+    header.levelCount = 1;
+    for (uint32_t size = std::max(header.tileCountX, header.tileCountY); size > 1; size >>= 1)
+        header.levelCount++;
+    if (header.tileCountX > 4096 || header.tileCountY > 4096 || header.levelCount > 15) {
+        printf("image is too large for tile size %d\n", tileSize);
+        return 1;
+    }
+
+    int levelWidth = header.tileCountX * tileSize;
+    int levelHeight = header.tileCountY * tileSize;
+    if (surface.width != levelWidth || surface.height != levelHeight)
+        surface = Resample(surface, levelWidth, levelHeight);
+
+    FILE* file = fopen(argv[2], "wb");
+    if (!file) {
+        printf("failed to write: %s\n", argv[2]);
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+
+    int storedSize = tileSize + 2 * border;
+    std::vector<uint8_t> tile((size_t)storedSize * storedSize * 4);
+    size_t pageCount = 0;
+    for (uint32_t level = 0; level < header.levelCount; level++) {
+        int tileCountX = std::max((int)header.tileCountX >> level, 1);
+        int tileCountY = std::max((int)header.tileCountY >> level, 1);
+        if (level > 0)
+            surface = Resample(surface, tileCountX * tileSize, tileCountY * tileSize);
+        for (int y = 0; y < tileCountY; y++) {
+            for (int x = 0; x < tileCountX; x++) {
+                CopyTile(surface, x, y, tileSize, border, tile);
+                fwrite(tile.data(), 1, tile.size(), file);
+                pageCount++;
+            }
+        }
+    }
+    fclose(file);
+
+    printf("%s -> %s: %ux%u tiles of %d (+%d border), %u levels, %zu pages, %.1f MB\n",
+        argv[1], argv[2], header.tileCountX, header.tileCountY, tileSize, border,
+        header.levelCount, pageCount, pageCount * tile.size() / (1024.0 * 1024.0));
+    return 0;
+}
\ No newline at end of file
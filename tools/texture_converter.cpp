@@ -0,0 +1,271 @@
+// image/*.jpg 등을 BC1 / BC3 / BC5 DDS 파일로 변환하는 offline 도구
+// usage: texture_converter <input> <output.dds> [bc1|bc3|bc5] [--no-mips]
+// OpenGL은 좌하단이 원점이므로 Image::Load(flipVertical = true)와 같이 상하를 뒤집어 저장한다
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <climits>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+enum class BlockFormat { BC1, BC3, BC5 };
+
+struct Surface {
+    int width { 0 };
+    int height { 0 };
+    std::vector<uint8_t> rgba;
+};
+
+static uint16_t PackRgb565(const uint8_t* c) {
+    return (uint16_t)(((c[0] * 31 + 127) / 255) << 11 |
+        ((c[1] * 63 + 127) / 255) << 5 |
+        ((c[2] * 31 + 127) / 255));
+}
+
+static void UnpackRgb565(uint16_t v, int* c) {
+    c[0] = ((v >> 11) & 31) * 255 / 31;
+    c[1] = ((v >> 5) & 63) * 255 / 63;
+    c[2] = (v & 31) * 255 / 31;
+}
+
+// 색 bounding box의 양 끝을 endpoint로 쓰는 간단한 BC1 encoder
+static void EncodeColorBlock(const uint8_t block[16][4], uint8_t* out) {
+    uint8_t minColor[3] = { 255, 255, 255 };
+    uint8_t maxColor[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        for (int k = 0; k < 3; k++) {
+            minColor[k] = std::min(minColor[k], block[i][k]);
+            maxColor[k] = std::max(maxColor[k], block[i][k]);
+        }
+    }
+    uint16_t color0 = PackRgb565(maxColor);
+    uint16_t color1 = PackRgb565(minColor);
+    // color0 > color1 이어야 4색 mode
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    int palette[4][3];
+    UnpackRgb565(color0, palette[0]);
+    UnpackRgb565(color1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+        palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestError = INT_MAX;
+            for (int p = 0; p < 4; p++) {
+                int error = 0;
+                for (int k = 0; k < 3; k++) {
+                    int d = block[i][k] - palette[p][k];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+    memcpy(out, &color0, 2);
+    memcpy(out + 2, &color1, 2);
+    memcpy(out + 4, &indices, 4);
+}
+
+// 단일 채널 block (BC3 alpha, BC5 R/G), 8단계 보간 mode
+static void EncodeChannelBlock(const uint8_t block[16][4], int channel, uint8_t* out) {
+    uint8_t minValue = 255;
+    uint8_t maxValue = 0;
+    for (int i = 0; i < 16; i++) {
+        minValue = std::min(minValue, block[i][channel]);
+        maxValue = std::max(maxValue, block[i][channel]);
+    }
+    out[0] = maxValue;
+    out[1] = minValue;
+
+    int palette[8] = { maxValue, minValue };
+    for (int p = 1; p < 7; p++)
+        palette[p + 1] = ((7 - p) * maxValue + p * minValue) / 7;
+
+    uint64_t indices = 0;
+    if (maxValue != minValue) {
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestError = INT_MAX;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(block[i][channel] - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (uint8_t)(indices >> (8 * i));
+}
+
+static std::vector<uint8_t> EncodeSurface(const Surface& surface, BlockFormat format) {
+    size_t blockSize = format == BlockFormat::BC1 ? 8 : 16;
+    int blockCountX = (surface.width + 3) / 4;
+    int blockCountY = (surface.height + 3) / 4;
+    std::vector<uint8_t> out(blockCountX * blockCountY * blockSize);
+
+    uint8_t block[16][4];
+    for (int by = 0; by < blockCountY; by++) {
+        for (int bx = 0; bx < blockCountX; bx++) {
+            // 경계 밖 texel은 가장자리 값을 반복
+            for (int i = 0; i < 16; i++) {
+                int x = std::min(bx * 4 + i % 4, surface.width - 1);
+                int y = std::min(by * 4 + i / 4, surface.height - 1);
+                memcpy(block[i], &surface.rgba[(y * surface.width + x) * 4], 4);
+            }
+            uint8_t* dst = &out[(by * blockCountX + bx) * blockSize];
+            switch (format) {
+                case BlockFormat::BC1:
+                    EncodeColorBlock(block, dst);
+                    break;
+                case BlockFormat::BC3:
+                    EncodeChannelBlock(block, 3, dst);
+                    EncodeColorBlock(block, dst + 8);
+                    break;
+                case BlockFormat::BC5:
+                    EncodeChannelBlock(block, 0, dst);
+                    EncodeChannelBlock(block, 1, dst + 8);
+                    break;
+            }
+        }
+    }
+    return out;
+}
+
+// 2x2 box filter
+static Surface Downsample(const Surface& src) {
+    Surface dst;
+    dst.width = std::max(src.width / 2, 1);
+    dst.height = std::max(src.height / 2, 1);
+    dst.rgba.resize(dst.width * dst.height * 4);
+    for (int y = 0; y < dst.height; y++) {
+        for (int x = 0; x < dst.width; x++) {
+            int x0 = std::min(x * 2, src.width - 1);
+            int x1 = std::min(x * 2 + 1, src.width - 1);
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int k = 0; k < 4; k++) {
+                int sum = src.rgba[(y0 * src.width + x0) * 4 + k] +
+                    src.rgba[(y0 * src.width + x1) * 4 + k] +
+                    src.rgba[(y1 * src.width + x0) * 4 + k] +
+                    src.rgba[(y1 * src.width + x1) * 4 + k];
+                dst.rgba[(y * dst.width + x) * 4 + k] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+static void WriteUint32(std::vector<uint8_t>& out, size_t offset, uint32_t value) {
+    memcpy(&out[offset], &value, 4);
+}
+
+static bool WriteDds(const std::string& filename, BlockFormat format, int width, int height,
+    const std::vector<std::vector<uint8_t>>& levels) {
+    // "DDS " + DDS_HEADER(124)
+    std::vector<uint8_t> header(128, 0);
+    memcpy(header.data(), "DDS ", 4);
+    WriteUint32(header, 4, 124);
+    // DDSD_CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+    WriteUint32(header, 8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+    WriteUint32(header, 12, height);
+    WriteUint32(header, 16, width);
+    WriteUint32(header, 20, (uint32_t)levels[0].size());
+    WriteUint32(header, 28, (uint32_t)levels.size());
+    WriteUint32(header, 76, 32);        // pixel format size
+    WriteUint32(header, 80, 0x4);       // DDPF_FOURCC
+    const char* fourCC = format == BlockFormat::BC1 ? "DXT1" :
+        format == BlockFormat::BC3 ? "DXT5" : "ATI2";
+    memcpy(&header[84], fourCC, 4);
+    // DDSCAPS_TEXTURE | (MIPMAP | COMPLEX)
+    WriteUint32(header, 108, levels.size() > 1 ? 0x1000 | 0x400000 | 0x8 : 0x1000);
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file)
+        return false;
+    fwrite(header.data(), 1, header.size(), file);
+    for (auto& level: levels)
+        fwrite(level.data(), 1, level.size(), file);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, const char** argv) {
+    if (argc < 3) {
+        printf("usage: %s <input> <output.dds> [bc1|bc3|bc5] [--no-mips]\n", argv[0]);
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+    bool mipmap = true;
+    std::string formatName;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--no-mips") == 0)
+            mipmap = false;
+        else
+            formatName = argv[i];
+    }
+
+    Surface surface;
+    int channelCount = 0;
+    stbi_set_flip_vertically_on_load(true);
+    uint8_t* data = stbi_load(input.c_str(), &surface.width, &surface.height, &channelCount, 4);
+    if (!data) {
+        printf("failed to load image: %s\n", input.c_str());
+        return 1;
+    }
+    surface.rgba.assign(data, data + surface.width * surface.height * 4);
+    stbi_image_free(data);
+
+    // format을 지정하지 않으면 alpha 유무로 결정
+    BlockFormat format = channelCount == 4 ? BlockFormat::BC3 : BlockFormat::BC1;
+    if (formatName == "bc1")
+        format = BlockFormat::BC1;
+    else if (formatName == "bc3")
+        format = BlockFormat::BC3;
+    else if (formatName == "bc5")
+        format = BlockFormat::BC5;
+    else if (!formatName.empty()) {
+        printf("unknown format: %s\n", formatName.c_str());
+        return 1;
+    }
+
+    const int baseWidth = surface.width;
+    const int baseHeight = surface.height;
+    std::vector<std::vector<uint8_t>> levels;
+    size_t rawSize = 0;
+    size_t compressedSize = 0;
+    while (true) {
+        levels.push_back(EncodeSurface(surface, format));
+        rawSize += surface.rgba.size() / 4 * channelCount;
+        compressedSize += levels.back().size();
+        if (!mipmap || (surface.width == 1 && surface.height == 1))
+            break;
+        surface = Downsample(surface);
+    }
+
+    if (!WriteDds(output, format, baseWidth, baseHeight, levels)) {
+        printf("failed to write: %s\n", output.c_str());
+        return 1;
+    }
+    printf("%s -> %s: %dx%d, %d levels, %.1f MB -> %.1f MB\n",
+        input.c_str(), output.c_str(), baseWidth, baseHeight, (int)levels.size(),
+        rawSize / (1024.0 * 1024.0), compressedSize / (1024.0 * 1024.0));
+    return 0;
+}
\ No newline at end of file